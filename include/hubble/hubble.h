@@ -52,6 +52,10 @@ int hubble_init(uint64_t utc_time, const void *key);
 /**
  * @brief Sets the current UTC time in the Hubble SDK.
  *
+ * Successive calls are also used to measure the drift of the device
+ * clock, which reduces the satellite re-transmissions added to
+ * compensate it.
+ *
  * @param utc_time The UTC time in milliseconds since the Unix epoch (January 1, 1970).
  *
  * @return
@@ -63,6 +67,9 @@ int hubble_utc_set(uint64_t utc_time);
 /**
  * @brief Sets the encryption key for advertisement data creation.
  *
+ * Keys derived from it are cached. When the key is changed in place,
+ * this function must be called again so they are derived again.
+ *
  * @param key An opaque pointer to the key.
  *
  * @return
@@ -12,9 +12,11 @@
 #ifndef INCLUDE_HUBBLE_PORT_SAT_RADIO_H
 #define INCLUDE_HUBBLE_PORT_SAT_RADIO_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#include <hubble/sat.h>
 #include <hubble/sat/packet.h>
 
 #ifdef __cplusplus
@@ -80,6 +82,38 @@ extern "C" {
 #define HUBBLE_SAT_PREAMBLE_SEQUENCE (int8_t[]){31, 0, 31, 0, 31, 0, 31, 31}
 #endif
 
+/**
+ * @brief Number of elements in @ref HUBBLE_SAT_PREAMBLE_SEQUENCE.
+ */
+#define HUBBLE_SAT_PREAMBLE_LENGTH 8U
+
+/**
+ * @brief Max number of entries in a packet transmission schedule.
+ *
+ * Every preamble element and every symbol takes at most two entries
+ * (on and off periods).
+ */
+#define HUBBLE_SAT_SCHEDULE_ENTRIES_MAX                                        \
+	(2U * (HUBBLE_SAT_PREAMBLE_LENGTH + HUBBLE_PACKET_MAX_SIZE))
+
+/**
+ * @brief Entry of a packet transmission schedule.
+ *
+ * The radio must keep the given state (transmitting at @p step
+ * frequency steps above the reference frequency of @p channel, or not
+ * transmitting) for @p duration_us before moving to the next entry.
+ */
+struct hubble_sat_schedule_entry {
+	/** Time in microseconds this entry lasts. */
+	uint16_t duration_us;
+	/** Channel used as reference frequency. */
+	uint8_t channel;
+	/** Number of frequency steps from the reference frequency. */
+	uint8_t step;
+	/** False if there is no transmission during this entry. */
+	bool on;
+};
+
 /**
  * @brief Initialize the satellite radio port.
  *
@@ -107,6 +141,66 @@ int hubble_sat_port_init(void);
 int hubble_sat_channel_next_hop_get(uint8_t hopping_sequence, uint8_t channel,
 				    uint8_t *next_channel);
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+/**
+ * @brief Load the end of the last sequence number lease.
+ *
+ * Packet sequence numbers are leased in blocks of
+ * CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE. The device resumes
+ * from the end of the last stored lease after a reboot, so numbers are
+ * not reused.
+ *
+ * It is only needed with CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST.
+ *
+ * @param lease_end The end of the last lease, left unchanged when none
+ *                  was stored.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int hubble_sat_port_sequence_load(uint32_t *lease_end);
+
+/**
+ * @brief Store the end of a sequence number lease.
+ *
+ * Called once per lease, outside of any SDK lock. Calls may race, so
+ * ports must only replace the stored value with a larger one. When it
+ * fails the numbers of the allocation are not used.
+ *
+ * It is only needed with CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST.
+ *
+ * @param lease_end The end of the new lease.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int hubble_sat_port_sequence_store(uint32_t lease_end);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST */
+
+/**
+ * @brief Render a packet into a flat transmission schedule.
+ *
+ * The schedule contains the preamble and all packet symbols, with the
+ * channel hops and the on/off timing already resolved, so drivers can
+ * feed the radio from a timer or DMA chain instead of walking the packet
+ * symbol by symbol. Every transmitted element lasts
+ * @ref HUBBLE_WAIT_SYMBOL_US and is followed by an off period of
+ * @ref HUBBLE_WAIT_SYMBOL_OFF_US. Preamble elements without transmission
+ * last @ref HUBBLE_WAIT_PREAMBLE_US. Consecutive off periods are merged
+ * in a single entry.
+ *
+ * @param packet   The packet to render.
+ * @param schedule Buffer where the schedule is written.
+ *                 @ref HUBBLE_SAT_SCHEDULE_ENTRIES_MAX entries are
+ *                 enough for any packet.
+ * @param count    In: number of entries available in @p schedule.
+ *                 Out: number of entries written.
+ *
+ * @return 0 on success, -EINVAL if any parameter is invalid or -ENOMEM
+ *         if @p schedule is too small.
+ */
+int hubble_sat_packet_schedule_get(const struct hubble_sat_packet *packet,
+				   struct hubble_sat_schedule_entry *schedule,
+				   size_t *count);
+
 /**
  * @brief Transmit a packet over the satellite radio.
  *
@@ -119,14 +213,92 @@ int hubble_sat_channel_next_hop_get(uint8_t hopping_sequence, uint8_t channel,
  * @note This API is thread safe.
  *
  * @param packet Pointer to the packet structure containing the data to transmit.
- * @param retries The number of times this packet must be transmit.
+ * @param retries The number of times this packet must be transmit. It
+ *                must not be zero.
  * @param interval_s The time interval between transmissions.
  *
- * @return 0 on successful transmission, negative error code on failure.
+ * @return 0 on successful transmission, -EINVAL if the packet is NULL
+ *         or retries is zero, negative error code on other failures.
  */
 int hubble_sat_port_packet_send(const struct hubble_sat_packet *packet,
 				uint8_t retries, uint8_t interval_s);
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+/**
+ * @brief Record a packet transmission in the statistics.
+ *
+ * Ports call it after every transmission, including re-transmissions,
+ * while they own the radio.
+ *
+ * @param packet The transmitted packet.
+ * @param retry  True if it is a re-transmission.
+ */
+void hubble_sat_stats_transmission_record(
+	const struct hubble_sat_packet *packet, bool retry);
+
+/**
+ * @brief Record the time the radio was enabled in the statistics.
+ *
+ * Ports call it when the radio is disabled.
+ *
+ * @param duration_ms Time since the radio was enabled.
+ */
+void hubble_sat_stats_enabled_record(uint32_t duration_ms);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_STATS */
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+/**
+ * @brief Transmission request given to the port queue.
+ */
+struct hubble_sat_port_tx_request {
+	/** Packet to transmit. It must remain valid until @p cb is called. */
+	const struct hubble_sat_packet *packet;
+	/** Callback called when the transmission ends. Can be NULL. */
+	hubble_sat_packet_send_cb_t cb;
+	/** User data given to @p cb. */
+	void *user_data;
+	/** The number of times this packet must be transmit. */
+	uint8_t retries;
+	/** Time to wait before the first transmission in seconds. */
+	uint32_t delay_s;
+	/** The time interval between transmissions. */
+	uint8_t interval_s;
+	/** Transmission priority. Lower values go first. */
+	uint8_t priority;
+};
+
+/**
+ * @brief Queue the transmission of a packet over the satellite radio.
+ *
+ * Same as @ref hubble_sat_port_packet_send but it returns as soon as the
+ * packet is queued. The port keeps the radio enabled while there are
+ * queued packets and interleaves their re-transmissions, respecting the
+ * interval of each one. The callback of the request is called when all
+ * its transmissions end.
+ *
+ * @note This API is thread safe.
+ *
+ * @param request The transmission request. It is copied by the port.
+ *
+ * @return 0 if the packet was queued, -EBUSY if the packet is already
+ *         queued, -ENOMEM if the queue is full, -EAGAIN before
+ *         @ref hubble_sat_port_init or other negative error code on
+ *         failure.
+ */
+int hubble_sat_port_packet_enqueue(
+	const struct hubble_sat_port_tx_request *request);
+
+/**
+ * @brief Cancel a transmission queued with
+ * @ref hubble_sat_port_packet_enqueue.
+ *
+ * @param packet The packet being transmitted.
+ *
+ * @return 0 on success, -ENOENT if the packet is not queued.
+ */
+int hubble_sat_port_packet_send_cancel(const struct hubble_sat_packet *packet);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 /**
  * @}
  */
@@ -102,6 +102,25 @@ int hubble_log(enum hubble_log_level level, const char *format, ...);
  */
 int hubble_rand_get(uint8_t *buffer, size_t len);
 
+/**
+ * @brief Enter a critical section.
+ *
+ * It protects the state the SDK shares between threads, e.g. the packet
+ * sequence numbers or the satellite statistics. Critical sections are
+ * short and never block, so a spinlock or masking interrupts are
+ * enough. They are not nested.
+ *
+ * @return A key to give to @ref hubble_unlock.
+ */
+uint32_t hubble_lock(void);
+
+/**
+ * @brief Leave a critical section entered with @ref hubble_lock.
+ *
+ * @param key The key returned by @ref hubble_lock.
+ */
+void hubble_unlock(uint32_t key);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,6 +9,9 @@
 
 #include <stdint.h>
 
+#include <hubble/sat/ephemeris.h>
+#include <hubble/sat/orbit_bundle.h>
+#include <hubble/sat/pass_table.h>
 #include <hubble/sat/packet.h>
 
 #ifdef __cplusplus
@@ -35,6 +38,14 @@ enum hubble_sat_transmission_mode {
 	HUBBLE_SAT_RELIABILITY_NORMAL,
 	/** High reliability and higher power consumption */
 	HUBBLE_SAT_RELIABILITY_HIGH,
+	/**
+	 * Retries chosen from the pass geometry to meet
+	 * CONFIG_HUBBLE_SAT_NETWORK_DELIVERY_TARGET. Passes close to zenith
+	 * use fewer retries than passes at the edge of the footprint.
+	 * Same as @ref HUBBLE_SAT_RELIABILITY_NORMAL when the transmission
+	 * is not tied to a pass.
+	 */
+	HUBBLE_SAT_RELIABILITY_ADAPTIVE,
 };
 
 /**
@@ -49,6 +60,11 @@ enum hubble_sat_transmission_mode {
  *
  * @return 0 on successful transmission, or a negative error code on failure.
  *
+ * @note With CONFIG_HUBBLE_SAT_NETWORK_ASYNC the transmission queue
+ *       gives the radio up between its re-transmissions while this
+ *       function waits, so it only waits for the transmission on air.
+ *       The queued packets resume once it returns.
+ *
  * @warning This function checks if the packet is NULL but does not perform
  *          any validation on the packet structure. It is the caller's
  *          responsibility to ensure the packet is correctly formatted.
@@ -56,6 +72,250 @@ enum hubble_sat_transmission_mode {
 int hubble_sat_packet_send(const struct hubble_sat_packet *packet,
 			   enum hubble_sat_transmission_mode mode);
 
+/**
+ * @brief Estimate the nominal time on air of a packet transmission.
+ *
+ * It accounts for the transmissions of the given @p mode, without the
+ * retries @ref hubble_sat_packet_send adds to compensate the clock
+ * drift. Off periods between symbols are included, the intervals
+ * between re-transmissions are not.
+ *
+ * The result only depends on the packet and @p mode, it can be used to
+ * plan duty cycles.
+ *
+ * @param packet The packet to transmit.
+ * @param mode   Desired reliability for the transmission.
+ *
+ * @return The estimated time on air in microseconds or 0 if any of the
+ *         input parameters are invalid.
+ */
+uint64_t hubble_sat_airtime_estimate(const struct hubble_sat_packet *packet,
+				     enum hubble_sat_transmission_mode mode);
+
+/**
+ * @brief Estimate the time on air of a packet transmission right now.
+ *
+ * Same as @ref hubble_sat_airtime_estimate, plus the retries
+ * @ref hubble_sat_packet_send currently adds to compensate the clock
+ * drift since the last UTC sync. The result grows as time passes and
+ * drops back after @ref hubble_utc_set.
+ *
+ * @param packet The packet to transmit.
+ * @param mode   Desired reliability for the transmission.
+ *
+ * @return The estimated time on air in microseconds or 0 if any of the
+ *         input parameters are invalid.
+ */
+uint64_t hubble_sat_airtime_drift_estimate(
+	const struct hubble_sat_packet *packet,
+	enum hubble_sat_transmission_mode mode);
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+/**
+ * @brief Satellite transmission statistics.
+ */
+struct hubble_sat_stats {
+	/** Packets transmitted, not counting re-transmissions. */
+	uint32_t packets;
+	/** Re-transmissions performed. */
+	uint32_t retries;
+	/** Symbols transmitted, preamble included. */
+	uint64_t symbols;
+	/** Estimated time on air in microseconds. */
+	uint64_t airtime_us;
+	/** Time the radio was enabled in milliseconds. */
+	uint64_t enabled_ms;
+};
+
+/**
+ * @brief Get the satellite transmission statistics.
+ *
+ * Statistics are accumulated since boot or since the last call to
+ * @ref hubble_sat_stats_reset.
+ *
+ * @param stats Where the statistics are copied.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If @p stats is NULL.
+ */
+int hubble_sat_stats_get(struct hubble_sat_stats *stats);
+
+/**
+ * @brief Reset the satellite transmission statistics.
+ */
+void hubble_sat_stats_reset(void);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_STATS */
+
+/**
+ * @brief Callback called when an asynchronous transmission ends.
+ *
+ * @param packet    The packet given to @ref hubble_sat_packet_send_async.
+ * @param status    0 if all transmissions were performed, -ECANCELED if
+ *                  the transmission was cancelled or a negative error code
+ *                  on failure.
+ * @param user_data The user data given to @ref hubble_sat_packet_send_async.
+ */
+typedef void (*hubble_sat_packet_send_cb_t)(
+	const struct hubble_sat_packet *packet, int status, void *user_data);
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+/**
+ * @brief Priority used by @ref hubble_sat_packet_send_async.
+ */
+#define HUBBLE_SAT_TX_PRIORITY_DEFAULT 8U
+
+/**
+ * @brief Queue a packet for transmission without blocking the caller.
+ *
+ * This function adds a packet (and its re-transmissions) to the
+ * transmission queue and returns immediately. All queued packets share
+ * the same radio enable window and their re-transmissions are
+ * interleaved, each one respecting its own interval. When more than one
+ * packet is due, the one with the lowest @p priority value goes first.
+ *
+ * The given callback is called from the SDK context once all
+ * transmissions of the packet end.
+ *
+ * @param packet    A pointer to the @ref hubble_sat_packet structure
+ *                  containing the data to be transmitted. It must remain
+ *                  valid until @p cb is called.
+ * @param mode      Desired reliability for the transmission.
+ * @param priority  Transmission priority. Lower values go first.
+ * @param cb        Callback called when the transmission ends. Can be NULL.
+ * @param user_data User data given to @p cb.
+ *
+ * @retval 0       If the packet was queued.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -EBUSY  If the packet is already queued.
+ * @retval -ENOMEM If the queue is full
+ *                 (CONFIG_HUBBLE_SAT_NETWORK_TX_QUEUE_SIZE).
+ * @retval -EAGAIN If called before @ref hubble_init.
+ */
+int hubble_sat_packet_enqueue(const struct hubble_sat_packet *packet,
+			      enum hubble_sat_transmission_mode mode,
+			      uint8_t priority, hubble_sat_packet_send_cb_t cb,
+			      void *user_data);
+
+/**
+ * @brief Transmit a packet without blocking the caller.
+ *
+ * Same as @ref hubble_sat_packet_enqueue using
+ * @ref HUBBLE_SAT_TX_PRIORITY_DEFAULT.
+ *
+ * @param packet    A pointer to the @ref hubble_sat_packet structure
+ *                  containing the data to be transmitted. It must remain
+ *                  valid until @p cb is called.
+ * @param mode      Desired reliability for the transmission.
+ * @param cb        Callback called when the transmission ends. Can be NULL.
+ * @param user_data User data given to @p cb.
+ *
+ * @retval 0       If the transmission was scheduled.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -EBUSY  If the packet is already queued.
+ * @retval -ENOMEM If the queue is full.
+ * @retval -EAGAIN If called before @ref hubble_init.
+ */
+int hubble_sat_packet_send_async(const struct hubble_sat_packet *packet,
+				 enum hubble_sat_transmission_mode mode,
+				 hubble_sat_packet_send_cb_t cb,
+				 void *user_data);
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS
+/**
+ * @brief Queue a packet for transmission in the next satellite pass.
+ *
+ * Same as @ref hubble_sat_packet_enqueue but the transmissions are
+ * deferred to the next pass of the satellite over the device location
+ * (@ref hubble_next_pass_window_get) and spread evenly across the time
+ * the satellite is visible. The window is widened by the clock drift
+ * accumulated since the last UTC sync (measured over the recent syncs
+ * and bounded by CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR) instead of
+ * adding retries.
+ *
+ * When the visibility window is empty, because the ground track only
+ * touches the edge of the footprint, a window of
+ * CONFIG_HUBBLE_SAT_NETWORK_PASS_WINDOW_S seconds centered on the pass
+ * time is used.
+ *
+ * With @ref HUBBLE_SAT_RELIABILITY_ADAPTIVE the number of transmissions
+ * is the smallest one that meets CONFIG_HUBBLE_SAT_NETWORK_DELIVERY_TARGET.
+ * The probability of each transmission is estimated from the path loss
+ * at its time in the pass, given by the offset from the pass centre, the
+ * distance between the ground track and the device and the latitude,
+ * against CONFIG_HUBBLE_SAT_NETWORK_LINK_MARGIN_DB.
+ *
+ * @param packet    A pointer to the @ref hubble_sat_packet structure
+ *                  containing the data to be transmitted. It must remain
+ *                  valid until @p cb is called.
+ * @param mode      Desired reliability for the transmission.
+ * @param priority  Transmission priority. Lower values go first.
+ * @param orbit     Satellite orbital parameters.
+ * @param ground    Device location.
+ * @param cb        Callback called when the transmission ends. Can be NULL.
+ * @param user_data User data given to @p cb.
+ *
+ * @retval 0       If the packet was queued.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -EBUSY  If the packet is already queued.
+ * @retval -ENOMEM If the queue is full.
+ * @retval -EAGAIN If called before @ref hubble_init.
+ * @retval -ENOENT If no pass was found.
+ */
+int hubble_sat_packet_pass_enqueue(const struct hubble_sat_packet *packet,
+				   enum hubble_sat_transmission_mode mode,
+				   uint8_t priority,
+				   const struct orbit_info *orbit,
+				   const struct ground_info *ground,
+				   hubble_sat_packet_send_cb_t cb,
+				   void *user_data);
+
+/**
+ * @brief Queue a packet for transmission in the next satellite pass over
+ * a region.
+ *
+ * Same as @ref hubble_sat_packet_pass_enqueue using
+ * @ref hubble_next_pass_region_get to find the pass.
+ *
+ * @param packet    A pointer to the @ref hubble_sat_packet structure
+ *                  containing the data to be transmitted. It must remain
+ *                  valid until @p cb is called.
+ * @param mode      Desired reliability for the transmission.
+ * @param priority  Transmission priority. Lower values go first.
+ * @param orbit     Satellite orbital parameters.
+ * @param region    Region where the device is.
+ * @param cb        Callback called when the transmission ends. Can be NULL.
+ * @param user_data User data given to @p cb.
+ *
+ * @retval 0       If the packet was queued.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -EBUSY  If the packet is already queued.
+ * @retval -ENOMEM If the queue is full.
+ * @retval -EAGAIN If called before @ref hubble_init.
+ * @retval -ENOENT If no pass was found.
+ */
+int hubble_sat_packet_region_pass_enqueue(
+	const struct hubble_sat_packet *packet,
+	enum hubble_sat_transmission_mode mode, uint8_t priority,
+	const struct orbit_info *orbit, const struct ground_region_info *region,
+	hubble_sat_packet_send_cb_t cb, void *user_data);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS */
+
+/**
+ * @brief Cancel an asynchronous transmission.
+ *
+ * Pending re-transmissions of the packet are dropped and the callback
+ * given to @ref hubble_sat_packet_enqueue is called with -ECANCELED.
+ * A transmission already on air is not interrupted.
+ *
+ * @param packet The packet given to @ref hubble_sat_packet_enqueue.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If @p packet is NULL.
+ * @retval -ENOENT If @p packet is not queued.
+ */
+int hubble_sat_packet_send_cancel(const struct hubble_sat_packet *packet);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 /**
  * @}
  */
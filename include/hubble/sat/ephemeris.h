@@ -13,6 +13,7 @@
 #define INCLUDE_HUBBLE_SAT_EPHEMERIS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -115,6 +116,153 @@ int hubble_next_pass_get(const struct orbit_info *orbit, uint64_t t,
 			 const struct ground_info *ground,
 			 struct hubble_pass_info *pass);
 
+/**
+ * @struct hubble_pass_window_info
+ * @brief Represents a satellite pass and its visibility window.
+ *
+ * The satellite is visible from the ground station while it is more
+ * than 30 degrees above the horizon.
+ */
+struct hubble_pass_window_info {
+	/** The pass, same as given by @ref hubble_next_pass_get. */
+	struct hubble_pass_info pass;
+	/** Time the satellite becomes visible (Unix time, seconds since epoch). */
+	uint64_t start;
+	/** Time the satellite stops being visible (Unix time, seconds since epoch). */
+	uint64_t end;
+	/** Time of the maximum elevation (Unix time, seconds since epoch). */
+	uint64_t max_elevation_t;
+	/** Maximum elevation of the satellite above the horizon in degrees. */
+	double max_elevation;
+};
+
+/**
+ * @brief Get the next satellite pass and its visibility window.
+ *
+ * Same as @ref hubble_next_pass_get, but the visibility window of the
+ * pass is also computed, so the radio is only enabled while the
+ * satellite can be reached.
+ *
+ * The window is empty (@p start equal to @p end) when the ground track
+ * barely touches the edge of the footprint.
+ *
+ * @param orbit  Pointer to the satellite's orbital parameters.
+ * @param t      Current time or the time from which to start the
+ *               calculation.
+ * @param ground Pointer to the ground station's location.
+ * @param window The next satellite pass and its window in case of
+ *               success.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -ENOENT If no pass was found.
+ */
+int hubble_next_pass_window_get(const struct orbit_info *orbit, uint64_t t,
+				const struct ground_info *ground,
+				struct hubble_pass_window_info *window);
+
+/**
+ * @brief Get the next passes of a satellite constellation.
+ *
+ * Same as @ref hubble_next_pass_get for each one of the given orbits,
+ * but the terms that only depend on the ground station location are
+ * computed once for all of them.
+ *
+ * The next pass of every satellite is considered and the @p count
+ * earliest ones are returned, sorted by time. Satellites that never pass
+ * over the ground station are skipped.
+ *
+ * @param orbits  Orbital parameters of the satellites.
+ * @param n       Number of elements in @p orbits.
+ * @param t       Current time or the time from which to start the
+ *                calculation.
+ * @param ground  Pointer to the ground station's location.
+ * @param passes  The earliest passes in case of success.
+ * @param indexes Index in @p orbits of the satellite of each pass. Can be
+ *                NULL.
+ * @param count   In: number of elements in @p passes (and @p indexes).
+ *                Out: number of passes found.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid, or @p n
+ *                 or @p count is 0. @p count is not changed.
+ * @retval -ENOENT If no pass was found.
+ */
+int hubble_next_pass_multi_get(const struct orbit_info *orbits, size_t n,
+			       uint64_t t, const struct ground_info *ground,
+			       struct hubble_pass_info *passes,
+			       size_t *indexes, size_t *count);
+
+/**
+ * @brief Iterator over the successive passes of a satellite.
+ *
+ * @note The contents of this structure are internal and must only be
+ *       accessed through the pass iterator APIs.
+ */
+struct hubble_pass_iter {
+	/** Satellite orbital parameters. */
+	const struct orbit_info *orbit;
+	/** Ground station location. */
+	struct ground_info ground;
+	/** Max longitude distance of a pass in degrees. */
+	double lon_tol;
+	/** Ground station latitude in radians. */
+	double lat_rad;
+	/** Right ascension offset of the crossings in radians. */
+	double ra_asin;
+	/** Sine of the argument of latitude of the crossings. */
+	double lam_sin[2];
+	/** Cosine of the argument of latitude of the crossings. */
+	double lam_cos[2];
+	/** Orbit count of the current crossings. */
+	int orbit_count;
+	/** Time of the current crossings of the ground station latitude. */
+	uint64_t crossing_t[2];
+	/** Longitude of the current crossings in degrees. */
+	double crossing_lon[2];
+	/** True once a pass was returned. */
+	bool started;
+	/** Time of the last pass returned. */
+	uint64_t t;
+};
+
+/**
+ * @brief Initialize a pass iterator.
+ *
+ * The iterator yields the passes of a satellite over a ground station,
+ * one after the other, without restarting the search on every pass.
+ *
+ * @param iter   The iterator to initialize.
+ * @param orbit  Pointer to the satellite's orbital parameters. It must
+ *               remain valid while the iterator is used.
+ * @param t      Time from which to start the iteration.
+ * @param ground Pointer to the ground station's location.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -ENOENT If the satellite never passes over the ground station.
+ */
+int hubble_pass_iter_init(struct hubble_pass_iter *iter,
+			  const struct orbit_info *orbit, uint64_t t,
+			  const struct ground_info *ground);
+
+/**
+ * @brief Get the next pass of a pass iterator.
+ *
+ * The first call gives the same pass as @ref hubble_next_pass_get for the
+ * time given to @ref hubble_pass_iter_init, following calls give the
+ * passes after the previous one.
+ *
+ * @param iter The pass iterator.
+ * @param pass The next satellite pass in case of success.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -ENOENT If no pass was found.
+ */
+int hubble_pass_iter_next(struct hubble_pass_iter *iter,
+			  struct hubble_pass_info *pass);
+
 /**
  * @brief Get the next satellite pass over a geographic region.
  *
@@ -131,6 +279,35 @@ int hubble_next_pass_get(const struct orbit_info *orbit, uint64_t t,
 int hubble_next_pass_region_get(const struct orbit_info *orbit, uint64_t t,
 				const struct ground_region_info *region,
 				struct hubble_pass_info *pass);
+
+/**
+ * @brief Get the next satellite pass over each one of several regions.
+ *
+ * Same as @ref hubble_next_pass_region_get for each one of the given
+ * regions, but the terms that only depend on the latitude bounds of a
+ * region are computed once for all the regions with the same bounds
+ * (same @ref ground_region_info.lat_mid and
+ * @ref ground_region_info.lat_range).
+ *
+ * @param orbit   Pointer to the satellite's orbital parameters.
+ * @param t       Current time or the time from which to start the
+ *                calculation.
+ * @param regions The geographic regions.
+ * @param n       Number of elements in @p regions.
+ * @param passes  The next pass over each region. Passes of the regions
+ *                where none was found are zeroed.
+ * @param status  0 or -ENOENT for each region, telling if its pass was
+ *                found. Can be NULL.
+ * @param found   Number of passes found. Can be NULL.
+ *
+ * @retval 0       If the pass of at least one region was found.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -ENOENT If no pass was found.
+ */
+int hubble_next_pass_regions_get(const struct orbit_info *orbit, uint64_t t,
+				 const struct ground_region_info *regions,
+				 size_t n, struct hubble_pass_info *passes,
+				 int *status, size_t *found);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file orbit_bundle.h
+ * @brief Hubble Network Satellite Orbit Bundle APIs
+ **/
+
+#ifndef INCLUDE_HUBBLE_SAT_ORBIT_BUNDLE_H
+#define INCLUDE_HUBBLE_SAT_ORBIT_BUNDLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hubble/sat/ephemeris.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Hubble Sat Network Orbit Bundle APIs
+ * @defgroup hubble_sat_orbit_bundle_api Satellite Orbit Bundle APIs
+ * @{
+ *
+ * An orbit bundle carries the orbital elements of a constellation, e.g.
+ * in an ephemeris update. It is a @ref hubble_orbit_bundle_header
+ * followed by @ref hubble_orbit_bundle_header.count records of
+ * @ref hubble_orbit_bundle_header.record_size bytes, each one starting
+ * with a @ref hubble_orbit_record. All fields are little-endian and
+ * doubles are IEEE 754, so the records are used in place, without
+ * copies, on little-endian devices.
+ *
+ * Bundles are generated with tools/orbit_bundle.py.
+ */
+
+/** Magic number of an orbit bundle, "HORB" in the byte order of the file. */
+#define HUBBLE_ORBIT_BUNDLE_MAGIC   0x42524F48U
+
+/** Orbit bundle format version. */
+#define HUBBLE_ORBIT_BUNDLE_VERSION 1U
+
+/**
+ * @brief Header of an orbit bundle.
+ */
+struct hubble_orbit_bundle_header {
+	/** @ref HUBBLE_ORBIT_BUNDLE_MAGIC. */
+	uint32_t magic;
+	/** Format version, @ref HUBBLE_ORBIT_BUNDLE_VERSION. */
+	uint8_t version;
+	/** Reserved, zero. */
+	uint8_t reserved;
+	/** Number of records. */
+	uint16_t count;
+	/** Size of a record in bytes, a multiple of 8. Newer versions may
+	 *  append fields to @ref hubble_orbit_record.
+	 */
+	uint32_t record_size;
+	/** CRC-32 (IEEE 802.3) of the records. */
+	uint32_t crc;
+};
+
+/**
+ * @brief Record of an orbit bundle.
+ */
+struct hubble_orbit_record {
+	/** Orbital elements. */
+	struct orbit_info orbit;
+	/** Time from which the elements are valid (Unix time, seconds). */
+	uint64_t valid_start;
+	/** Time until which the elements are valid (Unix time, seconds). */
+	uint64_t valid_end;
+	/** Satellite identifier. */
+	uint32_t id;
+	/** Reserved, zero. */
+	uint32_t reserved;
+};
+
+/**
+ * @brief An orbit bundle opened with @ref hubble_orbit_bundle_open.
+ *
+ * @note The contents of this structure are internal and must only be
+ *       accessed through the orbit bundle APIs.
+ */
+struct hubble_orbit_bundle {
+	/** First record. */
+	const uint8_t *records;
+	/** Number of records. */
+	uint16_t count;
+	/** Size of a record in bytes. */
+	uint32_t record_size;
+};
+
+/**
+ * @brief Open an orbit bundle.
+ *
+ * The bundle is validated (header, size, CRC and elements of every
+ * record) but not copied. It must remain valid, e.g. in flash or in a
+ * memory mapped file, while the records are used.
+ *
+ * @param bundle The bundle to open.
+ * @param data   Bundle data. It must be 8 bytes aligned.
+ * @param len    Size of @p data in bytes.
+ *
+ * @retval 0        On success.
+ * @retval -EINVAL  If any of the input parameters are invalid.
+ * @retval -EBADMSG If the bundle is malformed or corrupted.
+ * @retval -ENOTSUP If the bundle version is not supported or the
+ *                  device is not little-endian.
+ */
+int hubble_orbit_bundle_open(struct hubble_orbit_bundle *bundle,
+			     const void *data, size_t len);
+
+/**
+ * @brief Get the number of records of an orbit bundle.
+ *
+ * @param bundle An opened orbit bundle.
+ *
+ * @return The number of records, 0 if @p bundle is NULL.
+ */
+size_t hubble_orbit_bundle_count(const struct hubble_orbit_bundle *bundle);
+
+/**
+ * @brief Get a record of an orbit bundle.
+ *
+ * @param bundle An opened orbit bundle.
+ * @param index  Index of the record.
+ *
+ * @return The record, in place in the bundle data, or NULL if
+ *         @p index is out of range.
+ */
+const struct hubble_orbit_record *
+hubble_orbit_bundle_record_get(const struct hubble_orbit_bundle *bundle,
+			       size_t index);
+
+/**
+ * @brief Find the orbital elements of a satellite.
+ *
+ * When more than one record of the satellite is valid at @p t, the one
+ * with the most recent epoch is used.
+ *
+ * @param bundle An opened orbit bundle.
+ * @param id     Satellite identifier.
+ * @param t      Time the elements are needed for.
+ *
+ * @return The elements, in place in the bundle data, or NULL if there
+ *         are none valid at @p t.
+ */
+const struct orbit_info *
+hubble_orbit_bundle_find(const struct hubble_orbit_bundle *bundle,
+			 uint32_t id, uint64_t t);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_HUBBLE_SAT_ORBIT_BUNDLE_H */
@@ -12,6 +12,7 @@
 #ifndef INCLUDE_HUBBLE_SAT_PACKET_H
 #define INCLUDE_HUBBLE_SAT_PACKET_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -79,18 +80,405 @@ struct hubble_sat_packet {
  * This function constructs a Hubble satellite packet by encoding the provided
  * payload data along with the device ID into the packet structure.
  *
+ * The packet carries an authentication tag (truncated AES-CMAC of the
+ * sequence number, the device ID and the payload) computed with a key
+ * derived daily from the key given to @ref hubble_init.
+ *
  * @param  packet  Pointer to the packet structure to be populated.
  * @param  dev_id  Device ID to be encoded in the packet.
  * @param  payload Pointer to the payload data to be included in the packet.
  * @param  length  Length of the payload data in bytes.
  *
  * @retval 0       On success.
- * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -EINVAL If any of the input parameters are invalid or no key
+ *                 was given (@ref hubble_init, @ref hubble_key_set).
  * @retval -ENOMEM If the payload length exceeds the maximum allowed size.
  */
 int hubble_sat_packet_get(struct hubble_sat_packet *packet, uint64_t dev_id,
 			  const void *payload, size_t length);
 
+/**
+ * @brief Number of bytes needed to store @ref HUBBLE_PACKET_MAX_SIZE
+ * symbols of 6 bits.
+ */
+#define HUBBLE_SAT_PACKED_SIZE ((HUBBLE_PACKET_MAX_SIZE * 6U + 7U) / 8U)
+
+/**
+ * @brief Packed representation of a Hubble packet.
+ *
+ * Symbols only use 6 bits, this structure stores four of them every
+ * three bytes (MSB first) and takes less memory than
+ * @ref hubble_sat_packet. It is meant for applications that keep many
+ * packets around, e.g. queued for a later pass.
+ */
+struct hubble_sat_packet_packed {
+	/**
+	 * @brief Packed symbols of the packet.
+	 */
+	uint8_t data[HUBBLE_SAT_PACKED_SIZE];
+	/**
+	 * @brief Number of symbols in the packet.
+	 */
+	uint8_t length;
+	/**
+	 * @brief Channel encoded in the packet that must be used to
+	 * transmit.
+	 */
+	uint8_t channel: 6;
+	/**
+	 * @brief Channel sequence to be used.
+	 */
+	uint8_t hopping_sequence: 2;
+};
+
+/**
+ * @brief Pack a Hubble satellite packet.
+ *
+ * @param  packed Pointer to the packed packet to be populated.
+ * @param  packet Pointer to the packet to pack.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ */
+int hubble_sat_packet_pack(struct hubble_sat_packet_packed *packed,
+			   const struct hubble_sat_packet *packet);
+
+/**
+ * @brief Unpack a Hubble satellite packet.
+ *
+ * @param  packet Pointer to the packet to be populated.
+ * @param  packed Pointer to the packed packet.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ */
+int hubble_sat_packet_unpack(struct hubble_sat_packet *packet,
+			     const struct hubble_sat_packet_packed *packed);
+
+/**
+ * @brief Get a symbol of a packed packet.
+ *
+ * Board drivers can use it to transmit a packed packet without
+ * unpacking it first.
+ *
+ * @param  packed Pointer to the packed packet.
+ * @param  index  Index of the symbol.
+ * @param  symbol Pointer where the symbol at @p index is written.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid or
+ *                 @p index is not lower than the packet length.
+ */
+int hubble_sat_packet_packed_symbol_get(
+	const struct hubble_sat_packet_packed *packed, size_t index,
+	uint8_t *symbol);
+
+#ifndef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED
+
+/** @brief Max number of data symbols (before error control) in a packet */
+#define HUBBLE_SAT_PACKET_FRAME_SYMBOLS_MAX 30
+
+/** @brief Max number of error control symbols in a packet */
+#define HUBBLE_SAT_PACKET_ECC_SYMBOLS_MAX   16
+
+/**
+ * @brief Precomputed encoding state for a device and a payload size.
+ *
+ * The protocol version and the device ID are the same for every packet
+ * a device sends with a given payload size. Since Reed-Solomon parity is
+ * linear, the parity of these fields is computed once and later combined
+ * with the parity of the fields that change (sequence number,
+ * authentication tag and payload).
+ *
+ * @note The contents of this structure are internal and must only be
+ *       filled by @ref hubble_sat_packet_template_init.
+ */
+struct hubble_sat_packet_template {
+	/**
+	 * @brief Symbols of the constant fields, before whitening.
+	 */
+	uint8_t symbols[HUBBLE_SAT_PACKET_FRAME_SYMBOLS_MAX];
+	/**
+	 * @brief Parity contribution of the constant fields.
+	 */
+	uint8_t parity[HUBBLE_SAT_PACKET_ECC_SYMBOLS_MAX];
+	/**
+	 * @brief Parity contribution of a unit value in each of the
+	 * sequence number symbols.
+	 */
+	uint8_t sequence_parity[2][HUBBLE_SAT_PACKET_ECC_SYMBOLS_MAX];
+	/**
+	 * @brief Device ID, used to compute the authentication tag.
+	 */
+	uint64_t dev_id;
+	/**
+	 * @brief Payload length in bytes.
+	 */
+	uint8_t length;
+	/**
+	 * @brief Number of data symbols.
+	 */
+	uint8_t symbols_length;
+	/**
+	 * @brief Number of error control symbols.
+	 */
+	uint8_t ecc;
+	/**
+	 * @brief Payload length as encoded in the physical header.
+	 */
+	uint8_t length_symbol;
+};
+
+/**
+ * @brief Precompute the constant part of packets for a device.
+ *
+ * Applications that send many packets with the same device ID and
+ * payload size can initialize a template once and use
+ * @ref hubble_sat_packet_from_template_get for each packet, which
+ * only encodes the sequence number and the payload.
+ *
+ * @param  tmpl    Pointer to the template to be initialized.
+ * @param  dev_id  Device ID to be encoded in the packets.
+ * @param  length  Length of the payload in bytes. Available sizes are
+ *                 0, 4, 9 and 13 (@ref HUBBLE_SAT_PAYLOAD_MAX).
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ */
+int hubble_sat_packet_template_init(struct hubble_sat_packet_template *tmpl,
+				    uint64_t dev_id, size_t length);
+
+/**
+ * @brief Build a Hubble satellite packet from a template.
+ *
+ * The resulting packet is the same that @ref hubble_sat_packet_get would
+ * produce for the device ID and payload size given to the template.
+ *
+ * @param  packet  Pointer to the packet structure to be populated.
+ * @param  tmpl    Pointer to a template initialized with
+ *                 @ref hubble_sat_packet_template_init.
+ * @param  payload Pointer to the payload data. It must hold the number
+ *                 of bytes given when the template was initialized.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid or no key
+ *                 was given (@ref hubble_init, @ref hubble_key_set).
+ */
+int hubble_sat_packet_from_template_get(
+	struct hubble_sat_packet *packet,
+	const struct hubble_sat_packet_template *tmpl, const void *payload);
+
+/**
+ * @brief Get a copy of a packet to be transmitted on another channel.
+ *
+ * The variant carries the same frame (sequence number, authentication
+ * tag and payload) but its physical header and whitening use the given
+ * channel. It is much cheaper than building the packet again.
+ *
+ * @param  packet  Packet built with @ref hubble_sat_packet_get or
+ *                 @ref hubble_sat_packet_from_template_get.
+ * @param  channel Channel of the variant.
+ * @param  variant Pointer to the packet structure to be populated. It
+ *                 can be the same as @p packet.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ */
+int hubble_sat_packet_channel_variant_get(
+	const struct hubble_sat_packet *packet, uint8_t channel,
+	struct hubble_sat_packet *variant);
+
+/** @brief Number of bytes of the header added to each fragment */
+#define HUBBLE_SAT_FRAGMENT_HEADER_SIZE 1U
+
+/** @brief Max number of message bytes carried by a fragment */
+#define HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX                                        \
+	(HUBBLE_SAT_PAYLOAD_MAX - HUBBLE_SAT_FRAGMENT_HEADER_SIZE)
+
+/** @brief Max number of fragments of a message */
+#define HUBBLE_SAT_FRAGMENTS_MAX 16U
+
+/** @brief Max number of bytes of a fragmented message */
+#define HUBBLE_SAT_MESSAGE_MAX                                                 \
+	(HUBBLE_SAT_FRAGMENTS_MAX * HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX)
+
+/**
+ * @brief Get the number of packets needed to send a message.
+ *
+ * @param  length  Length of the message in bytes.
+ *
+ * @return The number of packets or -EINVAL if the message is larger than
+ *         @ref HUBBLE_SAT_MESSAGE_MAX.
+ */
+int hubble_sat_packet_fragments_count(size_t length);
+
+/**
+ * @brief Split a message into Hubble satellite packets.
+ *
+ * The message is split into the fewest packets possible. Every packet
+ * carries a one byte header followed by up to
+ * @ref HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX bytes of the message. All
+ * packets use the biggest payload size except the last one, that uses
+ * the smallest size that fits the remaining bytes. Packets get
+ * consecutive sequence numbers.
+ *
+ * Fragment header layout (MSB first):
+ *  - 4 bits: fragment index.
+ *  - 1 bit:  set in the last fragment.
+ *  - 3 bits: number of padding bytes at the end of the last fragment.
+ *
+ * A receiver reassembles the message from the packets with sequence
+ * numbers starting at (sequence number - fragment index).
+ *
+ * @param  packets   Array where packets are written.
+ * @param  count     In: number of packets available in @p packets.
+ *                   Out: number of packets written.
+ * @param  dev_id    Device ID to be encoded in the packets.
+ * @param  message   Message to be sent.
+ * @param  length    Length of the message in bytes.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid or the
+ *                 message is larger than @ref HUBBLE_SAT_MESSAGE_MAX.
+ * @retval -ENOMEM If @p packets is too small
+ *                 (@ref hubble_sat_packet_fragments_count).
+ * @retval -ENOTSUP If the enabled payload sizes can not carry the
+ *                  message, e.g. the last fragment would need more than
+ *                  seven padding bytes.
+ */
+int hubble_sat_packet_fragments_get(struct hubble_sat_packet *packets,
+				    size_t *count, uint64_t dev_id,
+				    const void *message, size_t length);
+
+/** @brief Number of bytes of the header of an aggregated record */
+#define HUBBLE_SAT_RECORD_HEADER_SIZE 1U
+
+/** @brief Max number of bytes of an aggregated record value */
+#define HUBBLE_SAT_RECORD_VALUE_MAX                                            \
+	(HUBBLE_SAT_PAYLOAD_MAX - HUBBLE_SAT_RECORD_HEADER_SIZE)
+
+/** @brief Max record tag. Tag 0 is reserved for padding. */
+#define HUBBLE_SAT_RECORD_TAG_MAX 15U
+
+/** @brief Max number of packets produced by a flush */
+#define HUBBLE_SAT_AGGREGATOR_PACKETS_MAX 16U
+
+/**
+ * @brief Aggregation buffer of small application records.
+ *
+ * @note The contents of this structure are internal and must only be
+ *       accessed through the aggregator APIs.
+ */
+struct hubble_sat_aggregator {
+	/** Buffer where records are stored. */
+	uint8_t *buffer;
+	/** Size of @p buffer in bytes. */
+	size_t size;
+	/** Number of bytes stored. */
+	size_t length;
+	/** Number of bytes that makes the aggregator ready. */
+	size_t threshold;
+	/** Device ID to be encoded in the packets. */
+	uint64_t dev_id;
+	/** Max time in milliseconds a record waits to be sent. */
+	uint32_t max_delay_ms;
+	/** Uptime when the oldest record must be sent. */
+	uint64_t deadline_ms;
+};
+
+/**
+ * @brief Initialize an aggregation buffer.
+ *
+ * Applications that produce small and irregular readings can add them
+ * as tagged records instead of building a packet for each one. When the
+ * aggregator is ready (@ref hubble_sat_aggregator_ready), records are
+ * packed in as few packets as possible, each using the smallest payload
+ * size that holds its records.
+ *
+ * Each record is a header byte (tag in the 4 most significant bits and
+ * value length in the 4 least significant bits) followed by the value.
+ * Records do not span packets and a zero header ends the records of a
+ * packet.
+ *
+ * @param  agg          Pointer to the aggregator to be initialized.
+ * @param  dev_id       Device ID to be encoded in the packets.
+ * @param  buffer       Buffer where records are stored. It must remain
+ *                      valid while the aggregator is used.
+ * @param  size         Size of @p buffer in bytes.
+ * @param  threshold    Number of stored bytes that makes the aggregator
+ *                      ready. 0 to only use @p max_delay_ms.
+ * @param  max_delay_ms Max time in milliseconds a record waits before
+ *                      the aggregator is ready.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ */
+int hubble_sat_aggregator_init(struct hubble_sat_aggregator *agg,
+			       uint64_t dev_id, void *buffer, size_t size,
+			       size_t threshold, uint32_t max_delay_ms);
+
+/**
+ * @brief Add a record to an aggregation buffer.
+ *
+ * @param  agg    Pointer to the aggregator.
+ * @param  tag    Record tag, between 1 and @ref HUBBLE_SAT_RECORD_TAG_MAX.
+ * @param  value  Record value.
+ * @param  length Length of @p value, at most
+ *                @ref HUBBLE_SAT_RECORD_VALUE_MAX bytes.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid or the
+ *                 record does not fit in the largest enabled payload
+ *                 size.
+ * @retval -ENOMEM If the record does not fit in the buffer or in
+ *                 @ref HUBBLE_SAT_AGGREGATOR_PACKETS_MAX packets. The
+ *                 aggregator must be flushed first.
+ */
+int hubble_sat_aggregator_add(struct hubble_sat_aggregator *agg, uint8_t tag,
+			      const void *value, size_t length);
+
+/**
+ * @brief Check whether an aggregation buffer should be flushed.
+ *
+ * @param  agg Pointer to the aggregator.
+ *
+ * @return true if there are records and either the threshold was
+ *         reached or the oldest record waited for the max delay.
+ */
+bool hubble_sat_aggregator_ready(const struct hubble_sat_aggregator *agg);
+
+/**
+ * @brief Get the number of packets needed to flush an aggregation
+ * buffer.
+ *
+ * @param  agg Pointer to the aggregator.
+ *
+ * @return The number of packets or a negative error code.
+ */
+int hubble_sat_aggregator_packets_count(
+	const struct hubble_sat_aggregator *agg);
+
+/**
+ * @brief Pack the records of an aggregation buffer into packets.
+ *
+ * The aggregator is emptied on success.
+ *
+ * @param  agg     Pointer to the aggregator.
+ * @param  packets Array where packets are written.
+ * @param  count   In: number of packets available in @p packets.
+ *                 Out: number of packets written.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -ENOMEM If @p packets is too small
+ *                 (@ref hubble_sat_aggregator_packets_count).
+ */
+int hubble_sat_aggregator_flush(struct hubble_sat_aggregator *agg,
+				struct hubble_sat_packet *packets,
+				size_t *count);
+
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED */
+
 /**
  * @}
  */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file pass_table.h
+ * @brief Hubble Network Satellite Pass Table APIs
+ **/
+
+#ifndef INCLUDE_HUBBLE_SAT_PASS_TABLE_H
+#define INCLUDE_HUBBLE_SAT_PASS_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hubble/sat/ephemeris.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Hubble Sat Network Pass Table APIs
+ * @defgroup hubble_sat_pass_table_api Satellite Pass Table APIs
+ * @{
+ *
+ * A pass table carries the passes of the constellation over a fixed
+ * location or region, precomputed on a host for a given horizon.
+ * Looking a pass up is a binary search, without any floating point
+ * operation, so devices that only use pass tables can be built without
+ * the ephemeris (CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS).
+ *
+ * A table is a header followed by @ref HUBBLE_PASS_TABLE_ENTRY_SIZE
+ * bytes entries sorted by time, which do not overlap:
+ *
+ * | Offset | Size | Field                                            |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 4    | @ref HUBBLE_PASS_TABLE_MAGIC                     |
+ * | 4      | 1    | Format version, @ref HUBBLE_PASS_TABLE_VERSION   |
+ * | 5      | 1    | Reserved, zero                                   |
+ * | 6      | 2    | Number of entries                                |
+ * | 8      | 4    | CRC-32 (IEEE 802.3) of the entries               |
+ * | 12     | 8    | Base time (Unix time, seconds)                   |
+ *
+ * Each entry is the start of a pass, in seconds from the base time
+ * (4 bytes), followed by its duration in seconds (2 bytes, not zero).
+ * Passes are sorted and do not overlap. All fields
+ * are little-endian and read byte by byte, so tables have no alignment
+ * requirement.
+ *
+ * Tables are generated with tools/pass_table.
+ */
+
+/** Magic number of a pass table, "HPTB" in the byte order of the file. */
+#define HUBBLE_PASS_TABLE_MAGIC       0x42545048U
+
+/** Pass table format version. */
+#define HUBBLE_PASS_TABLE_VERSION     1U
+
+/** Size of the header of a pass table in bytes. */
+#define HUBBLE_PASS_TABLE_HEADER_SIZE 20U
+
+/** Size of an entry of a pass table in bytes. */
+#define HUBBLE_PASS_TABLE_ENTRY_SIZE  6U
+
+/**
+ * @brief A pass table opened with @ref hubble_pass_table_open.
+ *
+ * @note The contents of this structure are internal and must only be
+ *       accessed through the pass table APIs.
+ */
+struct hubble_pass_table {
+	/** First entry. */
+	const uint8_t *entries;
+	/** Number of entries. */
+	uint16_t count;
+	/** Time the entries are relative to (Unix time, seconds). */
+	uint64_t base;
+};
+
+/**
+ * @brief Open a pass table.
+ *
+ * The table is validated (header, size, CRC, order and duration of the
+ * entries) but not copied. It must remain valid, e.g. in flash, while it is
+ * used.
+ *
+ * @param table The table to open.
+ * @param data  Table data.
+ * @param len   Size of @p data in bytes.
+ *
+ * @retval 0        On success.
+ * @retval -EINVAL  If any of the input parameters are invalid.
+ * @retval -EBADMSG If the table is malformed or corrupted.
+ * @retval -ENOTSUP If the table version is not supported.
+ */
+int hubble_pass_table_open(struct hubble_pass_table *table, const void *data,
+			   size_t len);
+
+/**
+ * @brief Get the number of passes of a pass table.
+ *
+ * @param table An opened pass table.
+ *
+ * @return The number of passes, 0 if @p table is NULL.
+ */
+size_t hubble_pass_table_count(const struct hubble_pass_table *table);
+
+/**
+ * @brief Get the next satellite pass from a pass table.
+ *
+ * The pass in progress at @p t, if any, is returned, otherwise the
+ * first one starting after @p t.
+ *
+ * Tables only carry the start and the duration of the passes, so
+ * @ref hubble_pass_info.t is the time the pass starts (the visibility
+ * window start for a location, as with a region pass),
+ * @ref hubble_pass_info.lon is 0 and @ref hubble_pass_info.ascending is
+ * false.
+ *
+ * @param table An opened pass table.
+ * @param t     Current time or the time from which to start the lookup.
+ * @param pass  The next satellite pass in case of success.
+ *
+ * @retval 0       On success.
+ * @retval -EINVAL If any of the input parameters are invalid.
+ * @retval -ENOENT If the table has no pass after @p t, it must be
+ *                 updated.
+ */
+int hubble_next_pass_table_get(const struct hubble_pass_table *table,
+			       uint64_t t, struct hubble_pass_info *pass);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_HUBBLE_SAT_PASS_TABLE_H */
@@ -29,6 +29,14 @@
 
 #if CONFIG_HUBBLE_SAT_NETWORK
 
+/*
+ * Computes the satellite passes on the device. Remove it (and set
+ * CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS=0 for the makefile) when passes
+ * are only looked up in precomputed tables, to leave the floating
+ * point ephemeris out.
+ */
+#define CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS 1
+
 /*
  * Use for fly by calculation. Enable this option
  * reduces code using polynomial approximation
@@ -36,6 +44,22 @@
  */
 /* #define CONFIG_HUBBLE_SAT_NETWORK_SMALL */
 
+/*
+ * Use single precision for the angles of the fly by calculation,
+ * for MCUs without a double precision FPU. Requires
+ * CONFIG_HUBBLE_SAT_NETWORK_SMALL. Pass times differ by up to 1
+ * second from the double precision calculation.
+ */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_SMALL_FLOAT */
+
+/*
+ * Accuracy of the polynomial approximations of
+ * CONFIG_HUBBLE_SAT_NETWORK_SMALL. Lower accuracies use lower degree
+ * polynomials. High is used when none is defined.
+ */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_SMALL_ACCURACY_MEDIUM */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_SMALL_ACCURACY_LOW */
+
 /*
  * Device time drift retry rate in parts per million (PPM).
  * Additional retries is added proportional to time since
@@ -43,6 +67,47 @@
  */
 #define CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR  500
 
+/*
+ * Worst case error, in milliseconds, of the UTC time given to
+ * hubble_utc_set(). The clock drift measured from successive syncs
+ * replaces CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR when it is lower.
+ */
+#define CONFIG_HUBBLE_SAT_NETWORK_SYNC_ACCURACY_MS 500
+
+/*
+ * Persist the satellite packet sequence numbers across reboots. The
+ * application implements hubble_sat_port_sequence_load() and
+ * hubble_sat_port_sequence_store(). The numbers are stored once for
+ * every CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE packets.
+ */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST 1 */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE 32 */
+
+/*
+ * Count transmissions and airtime, see hubble_sat_stats_get(). The
+ * radio port reports its transmissions with
+ * hubble_sat_stats_transmission_record() and
+ * hubble_sat_stats_enabled_record().
+ */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_STATS 1 */
+
+/*
+ * Build only the encoders of the payload sizes the application uses.
+ * Define CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM and one
+ * CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_<n> per supported size.
+ * Fragmentation needs the 4, 9 and 13 bytes sizes.
+ */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM 1 */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_0 1 */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_4 1 */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_9 1 */
+/* #define CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_13 1 */
+
+/*
+ * Asynchronous transmissions (CONFIG_HUBBLE_SAT_NETWORK_ASYNC) and
+ * channel diversity are only implemented by the Zephyr port.
+ */
+
 /* Protocol version
  *
  * Select only one of the following options:
@@ -34,6 +34,10 @@
 #define HUBBLE_WEAK __attribute__((weak))
 #endif
 
+#ifdef CONFIG_ESP_IDF_BUILD
+static portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
 uint64_t hubble_uptime_get(void)
 {
 	/*
@@ -79,3 +83,25 @@ HUBBLE_WEAK int hubble_log(enum hubble_log_level level, const char *format, ...)
 {
 	return 0;
 }
+
+HUBBLE_WEAK uint32_t hubble_lock(void)
+{
+#ifdef CONFIG_ESP_IDF_BUILD
+	taskENTER_CRITICAL(&_lock);
+#else
+	taskENTER_CRITICAL();
+#endif
+
+	return 0;
+}
+
+HUBBLE_WEAK void hubble_unlock(uint32_t key)
+{
+	(void)key;
+
+#ifdef CONFIG_ESP_IDF_BUILD
+	taskEXIT_CRITICAL(&_lock);
+#else
+	taskEXIT_CRITICAL();
+#endif
+}
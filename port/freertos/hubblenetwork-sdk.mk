@@ -26,10 +26,17 @@ endif
 ifeq ($(CONFIG_HUBBLE_SAT_NETWORK),1)
 HUBBLENETWORK_SDK_SOURCES += \
 	$(HUBBLENETWORK_SDK_SRC_DIR)/hubble_sat.c \
-	$(HUBBLENETWORK_SDK_SRC_DIR)/hubble_sat_ephemeris.c \
+	$(HUBBLENETWORK_SDK_SRC_DIR)/hubble_sat_orbit_bundle.c \
+	$(HUBBLENETWORK_SDK_SRC_DIR)/hubble_sat_pass_table.c \
 	$(HUBBLENETWORK_SDK_SRC_DIR)/utils/bitarray.c \
+	$(HUBBLENETWORK_SDK_SRC_DIR)/utils/crc32.c \
 	$(HUBBLENETWORK_SDK_SRC_DIR)/reed_solomon_encoder.c
 
+ifneq ($(CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS),0)
+HUBBLENETWORK_SDK_SOURCES += \
+	$(HUBBLENETWORK_SDK_SRC_DIR)/hubble_sat_ephemeris.c
+endif
+
 ifeq ($(CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_V1),1)
 HUBBLENETWORK_SDK_SOURCES += $(HUBBLENETWORK_SDK_SRC_DIR)/hubble_sat_packet.c
 else ifeq ($(CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED),1)
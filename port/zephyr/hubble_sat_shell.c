@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+
+#include <zephyr/shell/shell.h>
+
+#include <hubble/sat.h>
+
+static int _cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	int ret;
+	struct hubble_sat_stats stats;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	ret = hubble_sat_stats_get(&stats);
+	if (ret != 0) {
+		shell_error(sh, "Failed to get statistics (err %d)", ret);
+		return ret;
+	}
+
+	shell_print(sh, "packets:    %" PRIu32, stats.packets);
+	shell_print(sh, "retries:    %" PRIu32, stats.retries);
+	shell_print(sh, "symbols:    %" PRIu64, stats.symbols);
+	shell_print(sh, "airtime:    %" PRIu64 " us", stats.airtime_us);
+	shell_print(sh, "enabled:    %" PRIu64 " ms", stats.enabled_ms);
+
+	return 0;
+}
+
+static int _cmd_stats_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	hubble_sat_stats_reset();
+	shell_print(sh, "Statistics reset");
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	_stats_cmds,
+	SHELL_CMD_ARG(reset, NULL, "Reset the statistics", _cmd_stats_reset,
+		      1, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	_sat_cmds,
+	SHELL_CMD_ARG(stats, &_stats_cmds, "Show transmission statistics",
+		      _cmd_stats, 1, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(hubble_sat, &_sat_cmds, "Hubble satellite network",
+		   NULL);
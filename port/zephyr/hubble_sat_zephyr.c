@@ -6,9 +6,14 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <string.h>
 
 #include <zephyr/kernel.h>
 #include <zephyr/random/random.h>
+#if defined(CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST) &&                     \
+	defined(CONFIG_SETTINGS)
+#include <zephyr/settings/settings.h>
+#endif
 
 #include <hubble/sat.h>
 #include <hubble/port/sat_radio.h>
@@ -18,6 +23,12 @@
 
 K_SEM_DEFINE(_trans_sem, 1, 1);
 
+#if defined(CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST) &&                     \
+	defined(CONFIG_SETTINGS)
+#define _SEQUENCE_SETTINGS_SUBTREE "hubble/sat"
+#define _SEQUENCE_SETTINGS_KEY     _SEQUENCE_SETTINGS_SUBTREE "/seq"
+#endif
+
 static inline int16_t _time_offset_get_ms(void)
 {
 	/* Rand is anything in [0-255] (uint8_t). Let's split it into
@@ -31,29 +42,173 @@ static inline int16_t _time_offset_get_ms(void)
 	return offset_values[rand_value / 52];
 }
 
+static uint32_t _retry_delay_ms_get(uint8_t interval_s)
+{
+	return MAX(0, (interval_s * MSEC_PER_SEC) + _time_offset_get_ms());
+}
+
+#if defined(CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST) &&                     \
+	defined(CONFIG_SETTINGS)
+static int _sequence_settings_load_cb(const char *key, size_t len,
+				      settings_read_cb read_cb, void *cb_arg,
+				      void *param)
+{
+	ssize_t ret;
+	uint32_t *lease_end = param;
+
+	if ((key == NULL) || (strcmp(key, "seq") != 0) ||
+	    (len != sizeof(*lease_end))) {
+		return 0;
+	}
+
+	ret = read_cb(cb_arg, lease_end, sizeof(*lease_end));
+
+	return (ret < 0) ? (int)ret : 0;
+}
+
+/* Settings based storage of the sequence numbers. Applications can
+ * provide their own, and must when the settings subsystem is disabled.
+ */
+__weak int hubble_sat_port_sequence_load(uint32_t *lease_end)
+{
+	int ret;
+
+	ret = settings_subsys_init();
+	if (ret != 0) {
+		return ret;
+	}
+
+	return settings_load_subtree_direct(_SEQUENCE_SETTINGS_SUBTREE,
+					    _sequence_settings_load_cb,
+					    lease_end);
+}
+
+__weak int hubble_sat_port_sequence_store(uint32_t lease_end)
+{
+	int ret = 0;
+	static uint32_t stored;
+	static K_MUTEX_DEFINE(lock);
+
+	k_mutex_lock(&lock, K_FOREVER);
+
+	/* A racing allocation may have stored a later lease */
+	if (lease_end > stored) {
+		ret = settings_save_one(_SEQUENCE_SETTINGS_KEY, &lease_end,
+					sizeof(lease_end));
+		if (ret == 0) {
+			stored = lease_end;
+		}
+	}
+
+	k_mutex_unlock(&lock);
+
+	return ret;
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST && CONFIG_SETTINGS */
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY
+#define _CHANNEL_VARIANTS_NUM (CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_VARIANTS - 1)
+
+/* Builds the variants used by re-transmissions, each one starting on
+ * the next channel of the packet hopping sequence. A variant that can
+ * not be built falls back to the original packet.
+ */
+static void _channel_variants_build(const struct hubble_sat_packet *packet,
+				    struct hubble_sat_packet *variants,
+				    size_t count)
+{
+	uint8_t channel = packet->channel;
+
+	for (size_t i = 0; i < count; i++) {
+		if ((hubble_sat_channel_next_hop_get(packet->hopping_sequence,
+						     channel, &channel) != 0) ||
+		    (hubble_sat_packet_channel_variant_get(packet, channel,
+							   &variants[i]) != 0)) {
+			variants[i] = *packet;
+		}
+	}
+}
+
+static const struct hubble_sat_packet *
+_channel_variant_get(const struct hubble_sat_packet *packet,
+		     const struct hubble_sat_packet *variants, uint8_t attempt)
+{
+	uint8_t idx = attempt % CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_VARIANTS;
+
+	return (idx == 0U) ? packet : &variants[idx - 1];
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY */
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+/* Number of blocking transmissions waiting for the radio */
+static atomic_t _send_waiting;
+
+static void _queue_radio_request(void);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 int hubble_sat_port_packet_send(const struct hubble_sat_packet *packet,
 				uint8_t retries, uint8_t interval_s)
 {
 	int ret;
+	uint8_t attempt;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	int64_t enabled_ms;
+#endif
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY
+	struct hubble_sat_packet variants[_CHANNEL_VARIANTS_NUM];
+#endif
+
+	if ((packet == NULL) || (retries == 0U)) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY
+	_channel_variants_build(packet, variants,
+				MIN(_CHANNEL_VARIANTS_NUM, retries - 1));
+#endif
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+	/* The queue keeps the radio between its re-transmissions, ask it
+	 * to give the radio up so this call only waits for the
+	 * transmission on air.
+	 */
+	atomic_inc(&_send_waiting);
+	_queue_radio_request();
+#endif
 
 	/* Should we add a parameter in the API instead of K_FOREVER ? */
 	k_sem_take(&_trans_sem, K_FOREVER);
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+	atomic_dec(&_send_waiting);
+#endif
+
 	ret = hubble_sat_board_enable();
 	if (ret != 0) {
 		goto enable_error;
 	}
 
-	while (retries-- > 0) {
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	enabled_ms = k_uptime_get();
+#endif
+
+	for (attempt = 0U; attempt < retries; attempt++) {
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY
+		ret = hubble_sat_board_packet_send(
+			_channel_variant_get(packet, variants, attempt));
+#else
 		ret = hubble_sat_board_packet_send(packet);
+#endif
 		if (ret != 0) {
 			goto end;
 		}
 
-		if (retries > 0) {
-			uint32_t sleep_ms = MAX(0, (interval_s * MSEC_PER_SEC) +
-							   _time_offset_get_ms());
-			k_sleep(K_MSEC(sleep_ms));
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+		hubble_sat_stats_transmission_record(packet, attempt > 0U);
+#endif
+
+		if ((attempt + 1) < retries) {
+			k_sleep(K_MSEC(_retry_delay_ms_get(interval_s)));
 		}
 	}
 
@@ -65,13 +220,353 @@ end:
 		(void)hubble_sat_board_disable();
 	}
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	hubble_sat_stats_enabled_record(
+		(uint32_t)MIN(k_uptime_delta(&enabled_ms), UINT32_MAX));
+#endif
+
 enable_error:
 	k_sem_give(&_trans_sem);
 
 	return ret;
 }
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+/* Time to wait before trying again when a blocking transmission holds
+ * the radio.
+ */
+#define _QUEUE_BUSY_RETRY_MS 1000
+
+/* The radio is disabled when no transmission is due within this time.
+ * It is longer than any re-transmission interval (plus the random
+ * offset), so only deferred packets close the window, unless a blocking
+ * transmission waits for the radio.
+ */
+#define _QUEUE_IDLE_MS ((UINT8_MAX + 2) * MSEC_PER_SEC)
+
+static K_THREAD_STACK_DEFINE(_workq_stack,
+			     CONFIG_HUBBLE_SAT_NETWORK_ASYNC_STACK_SIZE);
+static struct k_work_q _workq;
+
+struct _tx_entry {
+	/* The entry is free when request.packet is NULL */
+	struct hubble_sat_port_tx_request request;
+	/* Uptime of the next transmission */
+	int64_t next_tx_ms;
+	bool cancelled;
+	/* Only accessed from the work queue */
+	uint8_t attempt;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY
+	struct hubble_sat_packet variants[_CHANNEL_VARIANTS_NUM];
+#endif
+};
+
+static struct {
+	struct k_work_delayable work;
+	struct k_spinlock lock;
+	struct _tx_entry entries[CONFIG_HUBBLE_SAT_NETWORK_TX_QUEUE_SIZE];
+	/* Set by hubble_sat_port_init() once the work queue runs */
+	bool started;
+	/* Only accessed from the work queue */
+	bool enabled;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	int64_t enabled_ms;
+#endif
+} _queue;
+
+/* Closes the enable window. Must be called from the work queue. */
+static int _queue_window_close(void)
+{
+	int ret;
+
+	if (!_queue.enabled) {
+		return 0;
+	}
+
+	ret = hubble_sat_board_disable();
+	_queue.enabled = false;
+	k_sem_give(&_trans_sem);
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	hubble_sat_stats_enabled_record(
+		(uint32_t)MIN(k_uptime_delta(&_queue.enabled_ms), UINT32_MAX));
+#endif
+
+	return ret;
+}
+
+static void _queue_entry_finish(struct _tx_entry *entry, int status)
+{
+	struct hubble_sat_port_tx_request request;
+	bool empty = true;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&_queue.lock);
+	request = entry->request;
+	entry->request.packet = NULL;
+	for (size_t i = 0; i < ARRAY_SIZE(_queue.entries); i++) {
+		if (_queue.entries[i].request.packet != NULL) {
+			empty = false;
+			break;
+		}
+	}
+	k_spin_unlock(&_queue.lock, key);
+
+	/* Last one in the queue, let's close the window before notifying so
+	 * a possible error disabling the radio is reported.
+	 */
+	if (empty) {
+		int ret = _queue_window_close();
+
+		if (status == 0) {
+			status = ret;
+		}
+	}
+
+	if (request.cb != NULL) {
+		request.cb(request.packet, status, request.user_data);
+	}
+}
+
+/* Picks the entry to transmit now. If none is due, the work is scheduled
+ * for the next one and wait_ms is set to the time until it, or to a
+ * negative value if the queue is empty.
+ */
+static struct _tx_entry *_queue_entry_next_get(int64_t *wait_ms)
+{
+	bool empty;
+	struct _tx_entry *next = NULL;
+	int64_t now = k_uptime_get();
+	int64_t next_tx_ms = INT64_MAX;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&_queue.lock);
+
+	for (size_t i = 0; i < ARRAY_SIZE(_queue.entries); i++) {
+		struct _tx_entry *entry = &_queue.entries[i];
+
+		if (entry->request.packet == NULL) {
+			continue;
+		}
+
+		if (entry->next_tx_ms > now) {
+			next_tx_ms = MIN(next_tx_ms, entry->next_tx_ms);
+			continue;
+		}
+
+		if ((next == NULL) ||
+		    (entry->request.priority < next->request.priority) ||
+		    ((entry->request.priority == next->request.priority) &&
+		     (entry->next_tx_ms < next->next_tx_ms))) {
+			next = entry;
+		}
+	}
+
+	empty = (next == NULL) && (next_tx_ms == INT64_MAX);
+	*wait_ms = empty ? -1 : (next_tx_ms - now);
+
+	/* Scheduling while holding the lock ensures that a packet queued
+	 * in the meantime is not delayed.
+	 */
+	if ((next == NULL) && !empty) {
+		k_work_reschedule_for_queue(&_workq, &_queue.work,
+					    K_MSEC(*wait_ms));
+	}
+
+	k_spin_unlock(&_queue.lock, key);
+
+	return next;
+}
+
+static void _queue_work_handler(struct k_work *work)
+{
+	int ret;
+	int64_t wait_ms;
+	struct _tx_entry *entry;
+	k_spinlock_key_t key;
+
+	ARG_UNUSED(work);
+
+	for (size_t i = 0; i < ARRAY_SIZE(_queue.entries); i++) {
+		bool cancelled;
+
+		key = k_spin_lock(&_queue.lock);
+		cancelled = (_queue.entries[i].request.packet != NULL) &&
+			    _queue.entries[i].cancelled;
+		k_spin_unlock(&_queue.lock, key);
+
+		if (cancelled) {
+			_queue_entry_finish(&_queue.entries[i], -ECANCELED);
+		}
+	}
+
+	entry = _queue_entry_next_get(&wait_ms);
+	if (entry == NULL) {
+		if ((wait_ms < 0) || (wait_ms > _QUEUE_IDLE_MS) ||
+		    (atomic_get(&_send_waiting) > 0)) {
+			(void)_queue_window_close();
+		}
+		return;
+	}
+
+	if (!_queue.enabled) {
+		if (k_sem_take(&_trans_sem, K_NO_WAIT) != 0) {
+			k_work_reschedule_for_queue(&_workq, &_queue.work,
+						    K_MSEC(_QUEUE_BUSY_RETRY_MS));
+			return;
+		}
+
+		ret = hubble_sat_board_enable();
+		if (ret != 0) {
+			k_sem_give(&_trans_sem);
+			_queue_entry_finish(entry, ret);
+			goto next;
+		}
+		_queue.enabled = true;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+		_queue.enabled_ms = k_uptime_get();
+#endif
+	}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_CHANNEL_DIVERSITY
+	if (entry->attempt == 0U) {
+		_channel_variants_build(entry->request.packet, entry->variants,
+					MIN(_CHANNEL_VARIANTS_NUM,
+					    entry->request.retries - 1));
+	}
+
+	ret = hubble_sat_board_packet_send(_channel_variant_get(
+		entry->request.packet, entry->variants, entry->attempt));
+#else
+	ret = hubble_sat_board_packet_send(entry->request.packet);
+#endif
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	if (ret == 0) {
+		hubble_sat_stats_transmission_record(entry->request.packet,
+						     entry->attempt > 0U);
+	}
+#endif
+	entry->attempt++;
+	if ((ret != 0) || (--entry->request.retries == 0U)) {
+		_queue_entry_finish(entry, ret);
+		goto next;
+	}
+
+	key = k_spin_lock(&_queue.lock);
+	entry->next_tx_ms =
+		k_uptime_get() + _retry_delay_ms_get(entry->request.interval_s);
+	k_spin_unlock(&_queue.lock, key);
+
+next:
+	k_work_reschedule_for_queue(&_workq, &_queue.work, K_NO_WAIT);
+}
+
+/* Wakes the queue up so it gives the radio up when idle */
+static void _queue_radio_request(void)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&_queue.lock);
+	if (_queue.started) {
+		k_work_reschedule_for_queue(&_workq, &_queue.work, K_NO_WAIT);
+	}
+	k_spin_unlock(&_queue.lock, key);
+}
+
+int hubble_sat_port_packet_enqueue(
+	const struct hubble_sat_port_tx_request *request)
+{
+	int ret = -ENOMEM;
+	struct _tx_entry *free_entry = NULL;
+	k_spinlock_key_t key;
+
+	if ((request->packet == NULL) || (request->retries == 0U)) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&_queue.lock);
+
+	/* The work queue is not running before hubble_init() */
+	if (!_queue.started) {
+		ret = -EAGAIN;
+		goto end;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(_queue.entries); i++) {
+		struct _tx_entry *entry = &_queue.entries[i];
+
+		if (entry->request.packet == request->packet) {
+			ret = -EBUSY;
+			goto end;
+		}
+
+		if ((free_entry == NULL) && (entry->request.packet == NULL)) {
+			free_entry = entry;
+		}
+	}
+
+	if (free_entry != NULL) {
+		free_entry->request = *request;
+		free_entry->next_tx_ms =
+			k_uptime_get() +
+			((int64_t)request->delay_s * MSEC_PER_SEC);
+		free_entry->cancelled = false;
+		free_entry->attempt = 0U;
+		k_work_reschedule_for_queue(&_workq, &_queue.work, K_NO_WAIT);
+		ret = 0;
+	}
+
+end:
+	k_spin_unlock(&_queue.lock, key);
+
+	return ret;
+}
+
+int hubble_sat_port_packet_send_cancel(const struct hubble_sat_packet *packet)
+{
+	int ret = -ENOENT;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&_queue.lock);
+
+	for (size_t i = 0; i < ARRAY_SIZE(_queue.entries); i++) {
+		struct _tx_entry *entry = &_queue.entries[i];
+
+		if ((entry->request.packet == packet) && !entry->cancelled) {
+			entry->cancelled = true;
+			k_work_reschedule_for_queue(&_workq, &_queue.work,
+						    K_NO_WAIT);
+			ret = 0;
+			break;
+		}
+	}
+
+	k_spin_unlock(&_queue.lock, key);
+
+	return ret;
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 int hubble_sat_port_init(void)
 {
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+	k_spinlock_key_t key;
+
+	/* Only hubble_init() calls it, from a single thread */
+	if (!_queue.started) {
+		k_work_queue_init(&_workq);
+		k_work_queue_start(&_workq, _workq_stack,
+				   K_THREAD_STACK_SIZEOF(_workq_stack),
+				   CONFIG_HUBBLE_SAT_NETWORK_ASYNC_THREAD_PRIORITY,
+				   NULL);
+		k_thread_name_set(&_workq.thread, "hubble_sat");
+		k_work_init_delayable(&_queue.work, _queue_work_handler);
+
+		key = k_spin_lock(&_queue.lock);
+		_queue.started = true;
+		k_spin_unlock(&_queue.lock, key);
+	}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 	return hubble_sat_board_init();
 }
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_core.h>
 #include <zephyr/logging/log_output.h>
@@ -17,6 +18,8 @@
 
 LOG_MODULE_REGISTER(hubblenetwork, CONFIG_HUBBLE_LOG_LEVEL);
 
+static struct k_spinlock _lock;
+
 uint64_t hubble_uptime_get(void)
 {
 	return (uint64_t)k_uptime_get();
@@ -56,3 +59,13 @@ int hubble_rand_get(uint8_t *buffer, size_t len)
 
 	return 0;
 }
+
+uint32_t hubble_lock(void)
+{
+	return (uint32_t)k_spin_lock(&_lock).key;
+}
+
+void hubble_unlock(uint32_t key)
+{
+	k_spin_unlock(&_lock, (k_spinlock_key_t){.key = (int)key});
+}
@@ -14,12 +14,51 @@
 #include <hubble/port/sys.h>
 #include <hubble/port/crypto.h>
 
+#include "hubble_priv.h"
+#include "utils/macros.h"
+
+#define BITS_PER_BYTE            8
+
+#define HUBBLE_KBKDF_MESSAGE_LEN 64
+
+/* Number of UTC syncs used to estimate the clock drift */
+#define HUBBLE_DRIFT_HISTORY_SIZE 8U
+
 static uint64_t utc_time_synced;
 static uint64_t utc_time_base;
 static const void *master_key;
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK
+/* Uptime and utc_time_base of the most recent syncs. The base moves
+ * by the drift of the local clock between syncs.
+ */
+static struct {
+	uint64_t uptime[HUBBLE_DRIFT_HISTORY_SIZE];
+	uint64_t base[HUBBLE_DRIFT_HISTORY_SIZE];
+	uint8_t next;
+	uint8_t count;
+} drift_history;
+
+static void _drift_history_add(uint64_t uptime, uint64_t base)
+{
+	uint32_t key = hubble_lock();
+
+	drift_history.uptime[drift_history.next] = uptime;
+	drift_history.base[drift_history.next] = base;
+	drift_history.next =
+		(drift_history.next + 1U) % HUBBLE_DRIFT_HISTORY_SIZE;
+	if (drift_history.count < HUBBLE_DRIFT_HISTORY_SIZE) {
+		drift_history.count++;
+	}
+
+	hubble_unlock(key);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK */
+
 int hubble_utc_set(uint64_t utc_time)
 {
+	uint64_t uptime;
+
 	if (utc_time == 0U) {
 		return -EINVAL;
 	}
@@ -27,7 +66,12 @@ int hubble_utc_set(uint64_t utc_time)
 	/* It holds when the device synced utc */
 	utc_time_synced = utc_time;
 
-	utc_time_base = utc_time - hubble_uptime_get();
+	uptime = hubble_uptime_get();
+	utc_time_base = utc_time - uptime;
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK
+	_drift_history_add(uptime, utc_time_base);
+#endif
 
 	return 0;
 }
@@ -40,6 +84,10 @@ int hubble_key_set(const void *key)
 
 	master_key = key;
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK
+	hubble_internal_sat_auth_key_reset();
+#endif
+
 	return 0;
 }
 
@@ -65,7 +113,7 @@ int hubble_init(uint64_t utc_time, const void *key)
 	}
 
 #ifdef CONFIG_HUBBLE_SAT_NETWORK
-	ret = hubble_sat_port_init();
+	ret = hubble_internal_sat_init();
 	if (ret != 0) {
 		HUBBLE_LOG_ERROR(
 			"Hubble Satellite Network initialization failed");
@@ -92,3 +140,144 @@ uint64_t hubble_internal_utc_time_last_synced_get(void)
 {
 	return utc_time_synced;
 }
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK
+uint32_t hubble_internal_clock_drift_ppm_estimate(const uint64_t *uptime,
+						  const uint64_t *base,
+						  uint8_t count)
+{
+	double x, y, mean_x = 0, mean_y = 0, sxx = 0, sxy = 0, drift;
+	uint64_t first_uptime, first_base;
+	uint64_t min_uptime = UINT64_MAX, max_uptime = 0;
+
+	if ((uptime == NULL) || (base == NULL) || (count < 2U)) {
+		return CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR;
+	}
+
+	first_uptime = uptime[0];
+	first_base = base[0];
+
+	/* Least squares fit of the base against the uptime. Values are
+	 * taken relative to the first sample to keep the precision.
+	 */
+	for (uint8_t i = 0; i < count; i++) {
+		mean_x += (double)(int64_t)(uptime[i] - first_uptime);
+		mean_y += (double)(int64_t)(base[i] - first_base);
+		min_uptime = HUBBLE_MIN(min_uptime, uptime[i]);
+		max_uptime = HUBBLE_MAX(max_uptime, uptime[i]);
+	}
+	mean_x /= count;
+	mean_y /= count;
+
+	if (max_uptime == min_uptime) {
+		return CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		x = (double)(int64_t)(uptime[i] - first_uptime) - mean_x;
+		y = (double)(int64_t)(base[i] - first_base) - mean_y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+
+	/* The sync error limits what can be measured over the history */
+	drift = ((sxy < 0) ? -sxy : sxy) / sxx;
+	drift += (2.0 * CONFIG_HUBBLE_SAT_NETWORK_SYNC_ACCURACY_MS) /
+		 (double)(max_uptime - min_uptime);
+	drift *= 1000000.0;
+
+	if (drift >= CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR) {
+		return CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR;
+	}
+
+	return (uint32_t)drift + 1U;
+}
+
+uint32_t hubble_internal_clock_drift_ppm_get(void)
+{
+	uint32_t key;
+	uint8_t count;
+	uint64_t uptime[HUBBLE_DRIFT_HISTORY_SIZE];
+	uint64_t base[HUBBLE_DRIFT_HISTORY_SIZE];
+
+	/* Copied so that the fit runs outside of the critical section */
+	key = hubble_lock();
+	count = drift_history.count;
+	memcpy(uptime, drift_history.uptime, sizeof(uptime));
+	memcpy(base, drift_history.base, sizeof(base));
+	hubble_unlock(key);
+
+	return hubble_internal_clock_drift_ppm_estimate(uptime, base, count);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK */
+
+int hubble_internal_kbkdf_counter(const uint8_t *key, const char *label,
+				  size_t label_len, const uint8_t *context,
+				  size_t context_len, uint8_t *output,
+				  size_t olen)
+{
+	int ret = 0;
+	uint8_t prf_output[HUBBLE_AES_BLOCK_SIZE];
+	uint8_t message[HUBBLE_KBKDF_MESSAGE_LEN];
+	uint32_t counter = 1U;
+	uint32_t total = 0U;
+	uint8_t separation_byte = 0x00;
+
+	/* Message format: Counter + Label + Context + Length (in bits) */
+	uint32_t message_length = sizeof(counter) + label_len +
+				  sizeof(separation_byte) + context_len +
+				  sizeof(uint32_t);
+
+	/* Check for message length overflow */
+	if (message_length >= sizeof(message)) {
+		ret = -EINVAL;
+		goto exit;
+	}
+
+	/* Prepare the message with Label, Context, and bit size */
+
+	/* Copy label after the counter */
+	memcpy((message + sizeof(counter)), label, label_len);
+	/* Separation byte (as defined by the standard) */
+	message[sizeof(counter) + label_len] = separation_byte;
+	/* Copy the context */
+	memcpy((message + sizeof(counter) + label_len + sizeof(separation_byte)),
+	       context, context_len);
+	/* Length in bits at the end */
+	memcpy((message + sizeof(counter) + label_len +
+		sizeof(separation_byte) + context_len),
+	       (uint8_t *)&(uint32_t){HUBBLE_CPU_TO_BE32(olen * BITS_PER_BYTE)},
+	       sizeof(uint32_t));
+
+	while (total < olen) {
+		size_t remaining = olen - total;
+
+		/* Insert counter into the message */
+		memcpy(message,
+		       (uint8_t *)&(uint32_t){HUBBLE_CPU_TO_BE32(counter)},
+		       sizeof(counter));
+
+		/* Perform AES-CMAC with the key and the prepared message */
+		ret = hubble_crypto_cmac(key, message, message_length,
+					 prf_output);
+		if (ret != 0) {
+			goto exit;
+		}
+
+		/* Copy the output */
+		if (remaining > HUBBLE_AES_BLOCK_SIZE) {
+			remaining = HUBBLE_AES_BLOCK_SIZE;
+		}
+
+		memcpy(output + total, prf_output, remaining);
+		total += remaining;
+		counter++;
+	}
+
+exit:
+	/* Clear sensitive information */
+	hubble_crypto_zeroize(prf_output, sizeof(prf_output));
+	hubble_crypto_zeroize(message, sizeof(message));
+
+	return ret;
+}
@@ -19,10 +19,7 @@
 #include "hubble_priv.h"
 #include "utils/macros.h"
 
-#define BITS_PER_BYTE               8
-
 #define HUBBLE_BLE_CONTEXT_LEN      12
-#define HUBBLE_BLE_MESSAGE_LEN      64
 #define HUBBLE_BLE_AUTH_LEN         16
 #define HUBBLE_BLE_ADVERTISE_PREFIX 2
 #define HUBBLE_BLE_PROTOCOL_VERSION 0b000000
@@ -127,76 +124,6 @@ static bool _nonce_values_check(uint32_t time_counter, uint16_t seq_no)
 	return true;
 }
 
-static int _kbkdf_counter(const uint8_t *key, const char *label,
-			  size_t label_len, const uint8_t *context,
-			  size_t context_len, uint8_t *output, size_t olen)
-{
-	int ret = 0;
-	uint8_t prf_output[HUBBLE_AES_BLOCK_SIZE];
-	uint8_t message[HUBBLE_BLE_MESSAGE_LEN];
-	uint32_t counter = 1U;
-	uint32_t total = 0U;
-	uint8_t separation_byte = 0x00;
-
-	/* Message format: Counter + Label + Context + Length (in bits) */
-	uint32_t message_length = sizeof(counter) + label_len +
-				  sizeof(separation_byte) + context_len +
-				  sizeof(uint32_t);
-
-	/* Check for message length overflow */
-	if (message_length >= sizeof(message)) {
-		ret = -EINVAL;
-		goto exit;
-	}
-
-	/* Prepare the message with Label, Context, and bit size */
-
-	/* Copy label after the counter */
-	memcpy((message + sizeof(counter)), label, label_len);
-	/* Separation byte (as defined by the standard) */
-	message[sizeof(counter) + label_len] = separation_byte;
-	/* Copy the context */
-	memcpy((message + sizeof(counter) + label_len + sizeof(separation_byte)),
-	       context, context_len);
-	/* Length in bits at the end */
-	memcpy((message + sizeof(counter) + label_len +
-		sizeof(separation_byte) + context_len),
-	       (uint8_t *)&(uint32_t){HUBBLE_CPU_TO_BE32(olen * BITS_PER_BYTE)},
-	       sizeof(uint32_t));
-
-	while (total < olen) {
-		size_t remaining = olen - total;
-
-		/* Insert counter into the message */
-		memcpy(message,
-		       (uint8_t *)&(uint32_t){HUBBLE_CPU_TO_BE32(counter)},
-		       sizeof(counter));
-
-		/* Perform AES-CMAC with the key and the prepared message */
-		ret = hubble_crypto_cmac(key, message, message_length,
-					 prf_output);
-		if (ret != 0) {
-			goto exit;
-		}
-
-		/* Copy the output */
-		if (remaining > HUBBLE_AES_BLOCK_SIZE) {
-			remaining = HUBBLE_AES_BLOCK_SIZE;
-		}
-
-		memcpy(output + total, prf_output, remaining);
-		total += remaining;
-		counter++;
-	}
-
-exit:
-	/* Clear sensitive information */
-	hubble_crypto_zeroize(prf_output, sizeof(prf_output));
-	hubble_crypto_zeroize(message, sizeof(message));
-
-	return ret;
-}
-
 static int _derived_key_get(enum hubble_ble_key_label label, uint32_t counter,
 			    uint8_t output_key[CONFIG_HUBBLE_KEY_SIZE])
 {
@@ -208,20 +135,22 @@ static int _derived_key_get(enum hubble_ble_key_label label, uint32_t counter,
 
 	switch (label) {
 	case HUBBLE_BLE_DEVICE_KEY:
-		err = _kbkdf_counter(master_key, "DeviceKey", strlen("DeviceKey"),
-				     context, strlen((const char *)context),
-				     output_key, CONFIG_HUBBLE_KEY_SIZE);
+		err = hubble_internal_kbkdf_counter(
+			master_key, "DeviceKey", strlen("DeviceKey"), context,
+			strlen((const char *)context), output_key,
+			CONFIG_HUBBLE_KEY_SIZE);
 		break;
 	case HUBBLE_BLE_NONCE_KEY:
-		err = _kbkdf_counter(master_key, "NonceKey", strlen("NonceKey"),
-				     context, strlen((const char *)context),
-				     output_key, CONFIG_HUBBLE_KEY_SIZE);
+		err = hubble_internal_kbkdf_counter(
+			master_key, "NonceKey", strlen("NonceKey"), context,
+			strlen((const char *)context), output_key,
+			CONFIG_HUBBLE_KEY_SIZE);
 		break;
 	case HUBBLE_BLE_ENCRYPTION_KEY:
-		err = _kbkdf_counter(master_key, "EncryptionKey",
-				     strlen("EncryptionKey"), context,
-				     strlen((const char *)context), output_key,
-				     CONFIG_HUBBLE_KEY_SIZE);
+		err = hubble_internal_kbkdf_counter(
+			master_key, "EncryptionKey", strlen("EncryptionKey"),
+			context, strlen((const char *)context), output_key,
+			CONFIG_HUBBLE_KEY_SIZE);
 		break;
 	default:
 		err = -EINVAL;
@@ -248,9 +177,10 @@ static int _derived_value_get(enum hubble_ble_value_label label,
 		if (ret != 0) {
 			goto exit;
 		}
-		ret = _kbkdf_counter(derived_key, "DeviceID", strlen("DeviceID"),
-				     context, strlen((const char *)context),
-				     output_value, output_len);
+		ret = hubble_internal_kbkdf_counter(
+			derived_key, "DeviceID", strlen("DeviceID"), context,
+			strlen((const char *)context), output_value,
+			output_len);
 		break;
 	case HUBBLE_BLE_NONCE_VALUE:
 		ret = _derived_key_get(HUBBLE_BLE_NONCE_KEY, time_counter,
@@ -258,9 +188,10 @@ static int _derived_value_get(enum hubble_ble_value_label label,
 		if (ret != 0) {
 			goto exit;
 		}
-		ret = _kbkdf_counter(derived_key, "Nonce", strlen("Nonce"),
-				     context, strlen((const char *)context),
-				     output_value, output_len);
+		ret = hubble_internal_kbkdf_counter(
+			derived_key, "Nonce", strlen("Nonce"), context,
+			strlen((const char *)context), output_value,
+			output_len);
 		break;
 	case HUBBLE_BLE_ENCRYPTION_VALUE:
 		ret = _derived_key_get(HUBBLE_BLE_ENCRYPTION_KEY, time_counter,
@@ -268,9 +199,10 @@ static int _derived_value_get(enum hubble_ble_value_label label,
 		if (ret != 0) {
 			goto exit;
 		}
-		ret = _kbkdf_counter(derived_key, "Key", strlen("Key"), context,
-				     strlen((const char *)context),
-				     output_value, output_len);
+		ret = hubble_internal_kbkdf_counter(
+			derived_key, "Key", strlen("Key"), context,
+			strlen((const char *)context), output_value,
+			output_len);
 		break;
 	default:
 		ret = -EINVAL;
@@ -7,6 +7,14 @@
 #ifndef SRC_HUBBLE_PRIV_H
 #define SRC_HUBBLE_PRIV_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <hubble/sat/ephemeris.h>
+
+/* Number of bits to represent a symbol */
+#define HUBBLE_SYMBOL_SIZE 6U
+
 const void *hubble_internal_key_get(void);
 
 uint64_t hubble_internal_utc_time_get(void);
@@ -16,4 +24,81 @@ uint64_t hubble_internal_utc_time_get(void);
  */
 uint64_t hubble_internal_utc_time_last_synced_get(void);
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK
+/* Clock drift in PPM measured over the recent UTC syncs. It is
+ * bounded by CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR, which is also used
+ * until there are enough syncs.
+ */
+uint32_t hubble_internal_clock_drift_ppm_get(void);
+
+/* Clock drift in PPM fitted on count syncs, given as the uptime and the
+ * UTC base (UTC minus uptime) of each sync, in milliseconds. It has the
+ * same bounds as hubble_internal_clock_drift_ppm_get().
+ */
+uint32_t hubble_internal_clock_drift_ppm_estimate(const uint64_t *uptime,
+						  const uint64_t *base,
+						  uint8_t count);
+
+/* Free space loss in dB, relative to the satellite at zenith, of the
+ * link between ground and the satellite offset_s seconds away from the
+ * centre of a pass. It is INFINITY when the satellite is below the
+ * horizon.
+ */
+double hubble_internal_pass_loss_db_get(const struct orbit_info *orbit,
+					const struct ground_info *ground,
+					const struct hubble_pass_info *pass,
+					int64_t offset_s);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK */
+
+/* KBKDF in counter mode (NIST SP 800-108) using AES-CMAC as PRF. */
+int hubble_internal_kbkdf_counter(const uint8_t *key, const char *label,
+				  size_t label_len, const uint8_t *context,
+				  size_t context_len, uint8_t *output,
+				  size_t olen);
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK
+/* Allocates count consecutive packet sequence numbers. Only the bits
+ * used by the protocol are meaningful, the numbers wrap around. It is
+ * thread safe.
+ */
+int hubble_internal_sat_sequence_get(uint16_t count, uint16_t *first);
+
+/* Resumes the sequence numbers after the last stored lease, see
+ * CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST.
+ */
+int hubble_internal_sat_sequence_load(void);
+
+/* Loads the sequence numbers and initializes the port. Queued
+ * transmissions are rejected with -EAGAIN until it succeeds.
+ */
+int hubble_internal_sat_init(void);
+
+/* Authentication tag of a satellite packet. It is the AES-CMAC, truncated
+ * to tag_len bytes, of the sequence number (2 bytes), the device id
+ * (8 bytes), both little endian, and the payload. The key is derived
+ * daily from the master key.
+ */
+int hubble_internal_sat_auth_tag_get(uint16_t sequence_number,
+				     uint64_t device_id, const void *payload,
+				     size_t length, uint8_t *tag,
+				     size_t tag_len);
+
+/* Drops the cached authentication key, it is derived again from the
+ * master key on the next packet.
+ */
+void hubble_internal_sat_auth_key_reset(void);
+
+#if defined(CONFIG_HUBBLE_SAT_NETWORK_ASYNC) &&                                \
+	defined(CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS)
+/* Transmissions HUBBLE_SAT_RELIABILITY_ADAPTIVE uses in a pass, spread
+ * across the window_s seconds starting at start_s. It grows with the
+ * path loss of the pass, see CONFIG_HUBBLE_SAT_NETWORK_LINK_MARGIN_DB.
+ */
+uint8_t hubble_internal_sat_adaptive_retries_get(
+	const struct orbit_info *orbit, const struct ground_info *ground,
+	const struct hubble_pass_info *pass, uint64_t start_s,
+	uint64_t window_s);
+#endif
+#endif /* CONFIG_HUBBLE_SAT_NETWORK */
+
 #endif /* SRC_HUBBLE_PRIV_H */
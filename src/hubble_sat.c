@@ -5,10 +5,17 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <hubble/sat.h>
+#include <hubble/sat/ephemeris.h>
 #include <hubble/port/sys.h>
+#include <hubble/port/crypto.h>
 #include <hubble/port/sat_radio.h>
 
 #include "hubble_priv.h"
@@ -25,25 +32,58 @@
 #define _SAT_RETRANSMISSION_RETRIES_NORMAL    8U
 #define _SAT_RETRANSMISSION_RETRIES_HIGH      16U
 
+/* Standard deviation of the link fading used by the adaptive mode */
+#define _SAT_LINK_FADING_SIGMA_DB             3.0
+
+/* The authentication key is derived daily from the master key */
+#define _SAT_AUTH_KEY_PERIOD_MS               86400000ULL
+#define _SAT_AUTH_CONTEXT_LEN                 12
+#define _SAT_AUTH_MESSAGE_LEN                                                  \
+	(sizeof(uint16_t) + sizeof(uint64_t) + HUBBLE_SAT_PAYLOAD_MAX)
+
+/* Derived authentication key cached for the current period, so only a
+ * single CMAC is computed per packet. The generation changes every time
+ * the master key is set, a key derived from the previous one is never
+ * cached.
+ */
+static struct {
+	uint8_t key[CONFIG_HUBBLE_KEY_SIZE];
+	uint32_t counter;
+	uint32_t generation;
+	bool valid;
+} _auth_key;
+
+/* Packet sequence numbers. Only the low bits are transmitted, so it
+ * wraps around.
+ */
+static struct {
+	/* Next sequence number to be allocated */
+	uint32_t next;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+	/* Sequence numbers until this one were stored as used. It is
+	 * what the device resumes from after a reboot.
+	 */
+	uint32_t lease_end;
+#endif
+} _sequence;
+
 /* This is pseudorandom pre-computed list of channel hopping. */
-static uint8_t _channel_hops[_SAT_HOPPING_SEQUENCE_INFO_NUM][HUBBLE_SAT_NUM_CHANNELS] = {
+static const uint8_t _channel_hops[_SAT_HOPPING_SEQUENCE_INFO_NUM][HUBBLE_SAT_NUM_CHANNELS] = {
 	{3, 14, 5, 6, 9, 2, 12, 8, 15, 4, 11, 13, 17, 10, 1, 7, 0, 18, 16},
 	{10, 3, 15, 5, 0, 17, 13, 6, 11, 4, 8, 18, 9, 14, 1, 12, 7, 16, 2},
 	{14, 5, 11, 3, 8, 2, 18, 4, 10, 13, 9, 1, 16, 17, 0, 6, 15, 12, 7},
 	{7, 0, 11, 18, 4, 2, 13, 5, 10, 17, 3, 9, 16, 14, 8, 12, 1, 6, 15},
 };
 
-static uint8_t _channel_idx_find(uint8_t hopping_sequence, uint8_t initial_channel)
-{
-	for (uint8_t idx = 0; idx < HUBBLE_SAT_NUM_CHANNELS; idx++) {
-		if (_channel_hops[hopping_sequence][idx] == initial_channel) {
-			return idx;
-		}
-	}
-
-	/* This condition should never happen */
-	return 0;
-}
+/* Inverse of _channel_hops. It gives the position of a channel in
+ * the hopping sequence.
+ */
+static const uint8_t _channel_hops_idx[_SAT_HOPPING_SEQUENCE_INFO_NUM][HUBBLE_SAT_NUM_CHANNELS] = {
+	{16, 14, 5, 0, 9, 2, 3, 15, 7, 4, 13, 10, 6, 11, 1, 8, 18, 12, 17},
+	{4, 14, 18, 1, 9, 3, 7, 16, 10, 12, 0, 8, 15, 6, 13, 2, 17, 5, 11},
+	{14, 11, 5, 3, 7, 1, 15, 18, 4, 10, 8, 2, 17, 9, 0, 16, 12, 13, 6},
+	{1, 16, 5, 10, 4, 7, 17, 0, 14, 11, 8, 2, 15, 6, 13, 18, 12, 9, 3},
+};
 
 int hubble_sat_channel_next_hop_get(uint8_t hopping_sequence, uint8_t channel,
 				    uint8_t *next_channel)
@@ -55,13 +95,518 @@ int hubble_sat_channel_next_hop_get(uint8_t hopping_sequence, uint8_t channel,
 		return -EINVAL;
 	}
 
-	idx = (_channel_idx_find(hopping_sequence, channel) + 1) %
+	idx = (_channel_hops_idx[hopping_sequence][channel] + 1) %
 	      HUBBLE_SAT_NUM_CHANNELS;
 	*next_channel = _channel_hops[hopping_sequence][idx];
 
 	return 0;
 }
 
+int hubble_internal_sat_sequence_get(uint16_t count, uint16_t *first)
+{
+	int ret = 0;
+	uint32_t key;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+	uint32_t next, lease_end = 0U, previous_lease_end;
+#endif
+
+	if (first == NULL) {
+		return -EINVAL;
+	}
+
+	key = hubble_lock();
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+	next = _sequence.next;
+	previous_lease_end = _sequence.lease_end;
+
+	/* Numbers are leased in blocks, so storage is only written once
+	 * per block.
+	 */
+	if ((_sequence.next + count) > _sequence.lease_end) {
+		_sequence.lease_end =
+			_sequence.next + count +
+			CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE;
+		lease_end = _sequence.lease_end;
+	}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST */
+
+	*first = (uint16_t)_sequence.next;
+	_sequence.next += count;
+
+	hubble_unlock(key);
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+	/* Storage may be slow, it is written out of the lock */
+	if (lease_end != 0U) {
+		ret = hubble_sat_port_sequence_store(lease_end);
+		if (ret != 0) {
+			HUBBLE_LOG_WARNING("Failed to store sequence number");
+
+			/* The numbers are given back unless a later
+			 * allocation already got the ones after them. The
+			 * next allocation past the stored lease tries again.
+			 */
+			key = hubble_lock();
+			if (_sequence.next == (next + count)) {
+				_sequence.next = next;
+			}
+			if (_sequence.lease_end == lease_end) {
+				_sequence.lease_end = previous_lease_end;
+			}
+			hubble_unlock(key);
+		}
+	}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST */
+
+	return ret;
+}
+
+int hubble_internal_sat_sequence_load(void)
+{
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+	int ret;
+	uint32_t key, lease_end = 0U;
+
+	ret = hubble_sat_port_sequence_load(&lease_end);
+	if (ret != 0) {
+		return ret;
+	}
+
+	/* Numbers of the last lease that were not used before the reboot
+	 * are skipped.
+	 */
+	key = hubble_lock();
+	_sequence.next = HUBBLE_MAX(_sequence.next, lease_end);
+	_sequence.lease_end = _sequence.next;
+	hubble_unlock(key);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST */
+
+	return 0;
+}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+/* Set once the port can queue transmissions */
+static bool _sat_ready;
+
+static bool _sat_ready_get(void)
+{
+	bool ready;
+	uint32_t key = hubble_lock();
+
+	ready = _sat_ready;
+	hubble_unlock(key);
+
+	return ready;
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
+int hubble_internal_sat_init(void)
+{
+	int ret;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+	uint32_t key;
+#endif
+
+	ret = hubble_internal_sat_sequence_load();
+	if (ret != 0) {
+		HUBBLE_LOG_ERROR("Failed to load sequence number");
+		return ret;
+	}
+
+	ret = hubble_sat_port_init();
+	if (ret != 0) {
+		return ret;
+	}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+	key = hubble_lock();
+	_sat_ready = true;
+	hubble_unlock(key);
+#endif
+
+	return 0;
+}
+
+static int _schedule_entry_add(struct hubble_sat_schedule_entry *schedule,
+			       size_t max, size_t *count, uint8_t channel,
+			       int8_t step, uint16_t duration_us)
+{
+	struct hubble_sat_schedule_entry *last =
+		(*count > 0) ? &schedule[*count - 1] : NULL;
+
+	/* Consecutive off periods are merged */
+	if ((step < 0) && (last != NULL) && !last->on) {
+		last->duration_us += duration_us;
+		return 0;
+	}
+
+	if (*count == max) {
+		return -ENOMEM;
+	}
+
+	schedule[*count] = (struct hubble_sat_schedule_entry){
+		.duration_us = duration_us,
+		.channel = channel,
+		.step = (step < 0) ? 0U : (uint8_t)step,
+		.on = (step >= 0),
+	};
+	(*count)++;
+
+	return 0;
+}
+
+/* A symbol is transmitted for HUBBLE_WAIT_SYMBOL_US and followed by
+ * an off period.
+ */
+static int _schedule_symbol_add(struct hubble_sat_schedule_entry *schedule,
+				size_t max, size_t *count, uint8_t channel,
+				int8_t step)
+{
+	int ret;
+
+	ret = _schedule_entry_add(schedule, max, count, channel, step,
+				  HUBBLE_WAIT_SYMBOL_US);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return _schedule_entry_add(schedule, max, count, channel, -1,
+				   HUBBLE_WAIT_SYMBOL_OFF_US);
+}
+
+int hubble_sat_packet_schedule_get(const struct hubble_sat_packet *packet,
+				   struct hubble_sat_schedule_entry *schedule,
+				   size_t *count)
+{
+	int ret;
+	size_t max;
+	uint8_t channel;
+	const int8_t *preamble = HUBBLE_SAT_PREAMBLE_SEQUENCE;
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_V1
+	uint8_t hop_idx;
+#endif
+
+	if ((packet == NULL) || (schedule == NULL) || (count == NULL) ||
+	    (packet->channel >= HUBBLE_SAT_NUM_CHANNELS) ||
+	    (packet->length > HUBBLE_PACKET_MAX_SIZE)) {
+		return -EINVAL;
+	}
+
+	max = *count;
+	*count = 0;
+	channel = packet->channel;
+
+	for (uint8_t i = 0; i < HUBBLE_SAT_PREAMBLE_LENGTH; i++) {
+		if (preamble[i] < 0) {
+			ret = _schedule_entry_add(schedule, max, count, channel,
+						  -1, HUBBLE_WAIT_PREAMBLE_US);
+		} else {
+			ret = _schedule_symbol_add(schedule, max, count,
+						   channel, preamble[i]);
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_V1
+	hop_idx = _channel_hops_idx[packet->hopping_sequence][channel];
+#endif
+
+	for (size_t i = 0; i < packet->length; i++) {
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_V1
+		/* Channel hops on every frame */
+		if ((i > 0) && ((i % HUBBLE_SAT_SYMBOLS_FRAME_MAX) == 0)) {
+			hop_idx = (hop_idx + 1) % HUBBLE_SAT_NUM_CHANNELS;
+			channel = _channel_hops[packet->hopping_sequence][hop_idx];
+		}
+#endif
+
+		ret = _schedule_symbol_add(schedule, max, count, channel,
+					   packet->data[i]);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+#define _SAT_SYMBOL_MASK ((1U << HUBBLE_SYMBOL_SIZE) - 1U)
+
+int hubble_sat_packet_pack(struct hubble_sat_packet_packed *packed,
+			   const struct hubble_sat_packet *packet)
+{
+	if ((packed == NULL) || (packet == NULL) ||
+	    (packet->length > HUBBLE_PACKET_MAX_SIZE)) {
+		return -EINVAL;
+	}
+
+	memset(packed->data, 0, sizeof(packed->data));
+
+	/* A symbol spans at most two bytes */
+	for (size_t i = 0; i < packet->length; i++) {
+		size_t bit = i * HUBBLE_SYMBOL_SIZE;
+		uint8_t offset = bit % 8U;
+		uint16_t value = (packet->data[i] & _SAT_SYMBOL_MASK)
+				 << (16U - HUBBLE_SYMBOL_SIZE - offset);
+
+		packed->data[bit / 8U] |= value >> 8;
+		if (offset > (8U - HUBBLE_SYMBOL_SIZE)) {
+			packed->data[(bit / 8U) + 1U] |= value & 0xFFU;
+		}
+	}
+
+	packed->length = packet->length;
+	packed->channel = packet->channel;
+	packed->hopping_sequence = packet->hopping_sequence;
+
+	return 0;
+}
+
+int hubble_sat_packet_packed_symbol_get(
+	const struct hubble_sat_packet_packed *packed, size_t index,
+	uint8_t *symbol)
+{
+	size_t bit;
+	uint8_t offset;
+	uint16_t value;
+
+	if ((packed == NULL) || (symbol == NULL) ||
+	    (packed->length > HUBBLE_PACKET_MAX_SIZE) ||
+	    (index >= packed->length)) {
+		return -EINVAL;
+	}
+
+	bit = index * HUBBLE_SYMBOL_SIZE;
+	offset = bit % 8U;
+	value = (uint16_t)packed->data[bit / 8U] << 8;
+	if (offset > (8U - HUBBLE_SYMBOL_SIZE)) {
+		value |= packed->data[(bit / 8U) + 1U];
+	}
+
+	*symbol = (value >> (16U - HUBBLE_SYMBOL_SIZE - offset)) &
+		  _SAT_SYMBOL_MASK;
+
+	return 0;
+}
+
+int hubble_sat_packet_unpack(struct hubble_sat_packet *packet,
+			     const struct hubble_sat_packet_packed *packed)
+{
+	if ((packet == NULL) || (packed == NULL) ||
+	    (packed->length > HUBBLE_PACKET_MAX_SIZE)) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < packed->length; i++) {
+		(void)hubble_sat_packet_packed_symbol_get(packed, i,
+							  &packet->data[i]);
+	}
+
+	packet->length = packed->length;
+	packet->channel = packed->channel;
+	packet->hopping_sequence = packed->hopping_sequence;
+
+	return 0;
+}
+
+/* Time on air of a single transmission, following the same timing
+ * as hubble_sat_packet_schedule_get().
+ */
+static uint32_t _packet_airtime_us_get(const struct hubble_sat_packet *packet,
+				       uint32_t *symbols)
+{
+	uint32_t airtime_us = 0U;
+	const int8_t *preamble = HUBBLE_SAT_PREAMBLE_SEQUENCE;
+
+	*symbols = packet->length;
+
+	for (uint8_t i = 0; i < HUBBLE_SAT_PREAMBLE_LENGTH; i++) {
+		if (preamble[i] < 0) {
+			airtime_us += HUBBLE_WAIT_PREAMBLE_US;
+		} else {
+			airtime_us +=
+				HUBBLE_WAIT_SYMBOL_US + HUBBLE_WAIT_SYMBOL_OFF_US;
+			(*symbols)++;
+		}
+	}
+
+	return airtime_us + (packet->length * (HUBBLE_WAIT_SYMBOL_US +
+					       HUBBLE_WAIT_SYMBOL_OFF_US));
+}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+/* Its 64-bit counters are only accessed under the lock, so they are
+ * not torn on 32-bit targets.
+ */
+static struct hubble_sat_stats _stats;
+
+void hubble_sat_stats_transmission_record(
+	const struct hubble_sat_packet *packet, bool retry)
+{
+	uint32_t key, symbols;
+	uint32_t airtime_us = _packet_airtime_us_get(packet, &symbols);
+
+	key = hubble_lock();
+
+	if (retry) {
+		_stats.retries++;
+	} else {
+		_stats.packets++;
+	}
+
+	_stats.symbols += symbols;
+	_stats.airtime_us += airtime_us;
+
+	hubble_unlock(key);
+}
+
+void hubble_sat_stats_enabled_record(uint32_t duration_ms)
+{
+	uint32_t key = hubble_lock();
+
+	_stats.enabled_ms += duration_ms;
+
+	hubble_unlock(key);
+}
+
+int hubble_sat_stats_get(struct hubble_sat_stats *stats)
+{
+	uint32_t key;
+
+	if (stats == NULL) {
+		return -EINVAL;
+	}
+
+	key = hubble_lock();
+	*stats = _stats;
+	hubble_unlock(key);
+
+	return 0;
+}
+
+void hubble_sat_stats_reset(void)
+{
+	uint32_t key = hubble_lock();
+
+	memset(&_stats, 0, sizeof(_stats));
+
+	hubble_unlock(key);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_STATS */
+
+/* The key is copied to the caller buffer, so the cache is only
+ * accessed under the lock.
+ */
+static int _auth_key_get(uint8_t key[CONFIG_HUBBLE_KEY_SIZE])
+{
+	int ret;
+	uint32_t lock;
+	bool cached;
+	uint32_t generation;
+	uint8_t context[_SAT_AUTH_CONTEXT_LEN] = {0};
+	const void *master_key;
+	uint32_t counter =
+		hubble_internal_utc_time_get() / _SAT_AUTH_KEY_PERIOD_MS;
+
+	lock = hubble_lock();
+	master_key = hubble_internal_key_get();
+	generation = _auth_key.generation;
+	cached = (master_key != NULL) && _auth_key.valid &&
+		 (_auth_key.counter == counter);
+	if (cached) {
+		memcpy(key, _auth_key.key, sizeof(_auth_key.key));
+	}
+	hubble_unlock(lock);
+
+	if (master_key == NULL) {
+		return -EINVAL;
+	}
+
+	if (cached) {
+		return 0;
+	}
+
+	snprintf((char *)context, sizeof(context), "%" PRIu32, counter);
+
+	ret = hubble_internal_kbkdf_counter(
+		master_key, "SatAuthKey", strlen("SatAuthKey"), context,
+		strlen((const char *)context), key, CONFIG_HUBBLE_KEY_SIZE);
+	if (ret != 0) {
+		hubble_crypto_zeroize(key, CONFIG_HUBBLE_KEY_SIZE);
+		return ret;
+	}
+
+	lock = hubble_lock();
+	if (_auth_key.generation == generation) {
+		memcpy(_auth_key.key, key, sizeof(_auth_key.key));
+		_auth_key.counter = counter;
+		_auth_key.valid = true;
+	}
+	hubble_unlock(lock);
+
+	return 0;
+}
+
+void hubble_internal_sat_auth_key_reset(void)
+{
+	uint32_t lock = hubble_lock();
+
+	hubble_crypto_zeroize(_auth_key.key, sizeof(_auth_key.key));
+	_auth_key.valid = false;
+	_auth_key.generation++;
+	hubble_unlock(lock);
+}
+
+int hubble_internal_sat_auth_tag_get(uint16_t sequence_number,
+				     uint64_t device_id, const void *payload,
+				     size_t length, uint8_t *tag,
+				     size_t tag_len)
+{
+	int ret;
+	size_t offset = 0;
+	uint8_t message[_SAT_AUTH_MESSAGE_LEN];
+	uint8_t cmac[HUBBLE_AES_BLOCK_SIZE];
+	uint8_t key[CONFIG_HUBBLE_KEY_SIZE];
+
+	if ((length > HUBBLE_SAT_PAYLOAD_MAX) || (tag_len > sizeof(cmac)) ||
+	    ((payload == NULL) && (length > 0U))) {
+		return -EINVAL;
+	}
+
+	ret = _auth_key_get(key);
+	if (ret != 0) {
+		HUBBLE_LOG_WARNING("Could not get the authentication key");
+		return ret;
+	}
+
+	for (uint8_t i = 0; i < sizeof(sequence_number); i++) {
+		message[offset++] = (sequence_number >> (i * 8)) & 0xFF;
+	}
+
+	for (uint8_t i = 0; i < sizeof(device_id); i++) {
+		message[offset++] = (device_id >> (i * 8)) & 0xFF;
+	}
+
+	if (length > 0U) {
+		memcpy(&message[offset], payload, length);
+		offset += length;
+	}
+
+	ret = hubble_crypto_cmac(key, message, offset, cmac);
+	if (ret == 0) {
+		memcpy(tag, cmac, tag_len);
+	}
+
+	hubble_crypto_zeroize(cmac, sizeof(cmac));
+	hubble_crypto_zeroize(key, sizeof(key));
+
+	return ret;
+}
+
 static int _transmission_params_get(enum hubble_sat_transmission_mode mode,
 				    uint8_t *retries, uint8_t *interval_s)
 {
@@ -73,6 +618,8 @@ static int _transmission_params_get(enum hubble_sat_transmission_mode mode,
 		*retries = 1U;
 		break;
 	case HUBBLE_SAT_RELIABILITY_NORMAL:
+	/* Without a pass there is no geometry to adapt to */
+	case HUBBLE_SAT_RELIABILITY_ADAPTIVE:
 		*interval_s = _SAT_RETRANSMISSION_INTERVAL_NORMAL_S;
 		*retries = _SAT_RETRANSMISSION_RETRIES_NORMAL;
 		break;
@@ -88,21 +635,81 @@ static int _transmission_params_get(enum hubble_sat_transmission_mode mode,
 	return ret;
 }
 
-static uint8_t _additional_retries_count(uint8_t interval_s)
+/* Clock drift (in seconds) accumulated since the last UTC sync */
+static uint64_t _clock_drift_s_get(void)
 {
 	uint64_t synced_interval_s;
 
+	synced_interval_s = (hubble_internal_utc_time_get() -
+			     hubble_internal_utc_time_last_synced_get()) /
+			    1000;
+
+	return (synced_interval_s * hubble_internal_clock_drift_ppm_get()) /
+	       1000000ULL;
+}
+
+static uint8_t _additional_retries_count(uint8_t interval_s)
+{
 	if (interval_s == 0U) {
 		return 0;
 	}
 
-	synced_interval_s = (hubble_internal_utc_time_get() -
-			     hubble_internal_utc_time_last_synced_get()) /
-			    1000;
+	return HUBBLE_MIN(UINT8_MAX, _clock_drift_s_get() / interval_s);
+}
 
-	return HUBBLE_MIN(UINT8_MAX, (synced_interval_s *
-				      CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR) /
-					     (1000000ULL * interval_s));
+static int _transmission_get(enum hubble_sat_transmission_mode mode,
+			     uint8_t *retries, uint8_t *interval_s)
+{
+	int ret;
+
+	ret = _transmission_params_get(mode, retries, interval_s);
+	if (ret < 0) {
+		HUBBLE_LOG_WARNING("Invalid mode given");
+		return ret;
+	}
+
+	*retries = HUBBLE_MIN(UINT8_MAX,
+			      *retries + _additional_retries_count(*interval_s));
+
+	return 0;
+}
+
+static uint64_t _airtime_estimate(const struct hubble_sat_packet *packet,
+				  enum hubble_sat_transmission_mode mode,
+				  bool drift)
+{
+	int ret;
+	uint32_t symbols;
+	uint8_t interval_s, retries;
+
+	if ((packet == NULL) || (packet->length > HUBBLE_PACKET_MAX_SIZE)) {
+		return 0U;
+	}
+
+	if (drift) {
+		ret = _transmission_get(mode, &retries, &interval_s);
+	} else {
+		ret = _transmission_params_get(mode, &retries, &interval_s);
+	}
+
+	if (ret < 0) {
+		return 0U;
+	}
+
+	return (uint64_t)retries * _packet_airtime_us_get(packet, &symbols);
+}
+
+uint64_t hubble_sat_airtime_estimate(const struct hubble_sat_packet *packet,
+				     enum hubble_sat_transmission_mode mode)
+{
+	return _airtime_estimate(packet, mode, false);
+}
+
+uint64_t hubble_sat_airtime_drift_estimate(
+	const struct hubble_sat_packet *packet,
+	enum hubble_sat_transmission_mode mode)
+{
+	return _airtime_estimate(packet, mode, true);
 }
 
 int hubble_sat_packet_send(const struct hubble_sat_packet *packet,
@@ -115,15 +722,11 @@ int hubble_sat_packet_send(const struct hubble_sat_packet *packet,
 		return -EINVAL;
 	}
 
-	ret = _transmission_params_get(mode, &retries, &interval_s);
+	ret = _transmission_get(mode, &retries, &interval_s);
 	if (ret < 0) {
-		HUBBLE_LOG_WARNING("Invalid mode given");
 		return ret;
 	}
 
-	retries = HUBBLE_MIN(UINT8_MAX,
-			     retries + _additional_retries_count(interval_s));
-
 	ret = hubble_sat_port_packet_send(packet, retries, interval_s);
 	if (ret < 0) {
 		HUBBLE_LOG_WARNING(
@@ -135,3 +738,269 @@ int hubble_sat_packet_send(const struct hubble_sat_packet *packet,
 
 	return 0;
 }
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+int hubble_sat_packet_enqueue(const struct hubble_sat_packet *packet,
+			      enum hubble_sat_transmission_mode mode,
+			      uint8_t priority, hubble_sat_packet_send_cb_t cb,
+			      void *user_data)
+{
+	int ret;
+	struct hubble_sat_port_tx_request request = {
+		.packet = packet,
+		.cb = cb,
+		.user_data = user_data,
+		.priority = priority,
+	};
+
+	if (packet == NULL) {
+		return -EINVAL;
+	}
+
+	if (!_sat_ready_get()) {
+		return -EAGAIN;
+	}
+
+	ret = _transmission_get(mode, &request.retries, &request.interval_s);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = hubble_sat_port_packet_enqueue(&request);
+	if (ret < 0) {
+		HUBBLE_LOG_WARNING("Hubble Satellite packet could not be queued");
+		return ret;
+	}
+
+	return 0;
+}
+
+int hubble_sat_packet_send_async(const struct hubble_sat_packet *packet,
+				 enum hubble_sat_transmission_mode mode,
+				 hubble_sat_packet_send_cb_t cb, void *user_data)
+{
+	return hubble_sat_packet_enqueue(packet, mode,
+					 HUBBLE_SAT_TX_PRIORITY_DEFAULT, cb,
+					 user_data);
+}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS
+/* Probability that a transmission is received given the free space
+ * loss relative to zenith. Fading around the link margin is modelled as
+ * log-normal.
+ */
+static double _transmission_success_get(double loss_db)
+{
+	double margin_db = CONFIG_HUBBLE_SAT_NETWORK_LINK_MARGIN_DB - loss_db;
+
+	return 0.5 * erfc(-margin_db / (_SAT_LINK_FADING_SIGMA_DB * sqrt(2.0)));
+}
+
+/* Smallest number of transmissions, spread across the window like
+ * _pass_request_fill does, whose delivery probability meets the target.
+ */
+uint8_t hubble_internal_sat_adaptive_retries_get(
+	const struct orbit_info *orbit, const struct ground_info *ground,
+	const struct hubble_pass_info *pass, uint64_t start_s,
+	uint64_t window_s)
+{
+	uint8_t retries;
+	uint64_t interval_s;
+	int64_t offset_s;
+	double failure, loss_db;
+	const double target = CONFIG_HUBBLE_SAT_NETWORK_DELIVERY_TARGET / 100.0;
+	const uint64_t centre_s = pass->t + (pass->duration / 2);
+
+	for (retries = 1U; retries < _SAT_RETRANSMISSION_RETRIES_HIGH;
+	     retries++) {
+		interval_s = HUBBLE_MIN(UINT8_MAX,
+					HUBBLE_MAX(1U, window_s / retries));
+		failure = 1.0;
+
+		for (uint8_t i = 0U; i < retries; i++) {
+			offset_s = (int64_t)(start_s + (interval_s / 2) +
+					     (i * interval_s)) -
+				   (int64_t)centre_s;
+			loss_db = hubble_internal_pass_loss_db_get(
+				orbit, ground, pass, offset_s);
+			failure *= 1.0 - _transmission_success_get(loss_db);
+		}
+
+		if ((1.0 - failure) >= target) {
+			break;
+		}
+	}
+
+	return retries;
+}
+
+/* Defers the request to the pass window and spreads the transmissions
+ * across it. Clock drift widens the window instead of adding retries.
+ */
+static int _pass_request_fill(struct hubble_sat_port_tx_request *request,
+			      enum hubble_sat_transmission_mode mode,
+			      const struct orbit_info *orbit,
+			      const struct ground_info *ground,
+			      const struct hubble_pass_info *pass,
+			      uint64_t now_s)
+{
+	int ret;
+	uint8_t interval_s;
+	uint64_t start_s, end_s, window_s, drift_s;
+
+	ret = _transmission_params_get(mode, &request->retries, &interval_s);
+	if (ret < 0) {
+		HUBBLE_LOG_WARNING("Invalid mode given");
+		return ret;
+	}
+
+	/* Point passes do not have duration, let's center a window on it */
+	if (pass->duration == 0U) {
+		start_s = pass->t - (CONFIG_HUBBLE_SAT_NETWORK_PASS_WINDOW_S / 2);
+		end_s = start_s + CONFIG_HUBBLE_SAT_NETWORK_PASS_WINDOW_S;
+	} else {
+		start_s = pass->t;
+		end_s = pass->t + pass->duration;
+	}
+
+	/* Rounded up to a whole second */
+	drift_s = _clock_drift_s_get() + 1U;
+	start_s = (start_s > (now_s + drift_s)) ? (start_s - drift_s) : now_s;
+	end_s += drift_s;
+	if (end_s <= start_s) {
+		return -ENOENT;
+	}
+
+	/* Each transmission goes in the middle of its slot */
+	window_s = end_s - start_s;
+	if (mode == HUBBLE_SAT_RELIABILITY_ADAPTIVE) {
+		request->retries = hubble_internal_sat_adaptive_retries_get(
+			orbit, ground, pass, start_s, window_s);
+	}
+
+	request->interval_s = HUBBLE_MIN(
+		UINT8_MAX, HUBBLE_MAX(1U, window_s / request->retries));
+	request->delay_s = HUBBLE_MIN(
+		UINT32_MAX, (start_s - now_s) + (request->interval_s / 2));
+
+	return 0;
+}
+
+static int _pass_enqueue(struct hubble_sat_port_tx_request *request,
+			 enum hubble_sat_transmission_mode mode,
+			 const struct orbit_info *orbit,
+			 const struct ground_info *ground,
+			 const struct hubble_pass_info *pass, uint64_t now_s)
+{
+	int ret;
+
+	ret = _pass_request_fill(request, mode, orbit, ground, pass, now_s);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = hubble_sat_port_packet_enqueue(request);
+	if (ret < 0) {
+		HUBBLE_LOG_WARNING("Hubble Satellite packet could not be queued");
+		return ret;
+	}
+
+	return 0;
+}
+
+int hubble_sat_packet_pass_enqueue(const struct hubble_sat_packet *packet,
+				   enum hubble_sat_transmission_mode mode,
+				   uint8_t priority,
+				   const struct orbit_info *orbit,
+				   const struct ground_info *ground,
+				   hubble_sat_packet_send_cb_t cb,
+				   void *user_data)
+{
+	int ret;
+	uint64_t now_s;
+	struct hubble_pass_window_info window;
+	struct hubble_sat_port_tx_request request = {
+		.packet = packet,
+		.cb = cb,
+		.user_data = user_data,
+		.priority = priority,
+	};
+
+	if ((packet == NULL) || (orbit == NULL) || (ground == NULL)) {
+		return -EINVAL;
+	}
+
+	if (!_sat_ready_get()) {
+		return -EAGAIN;
+	}
+
+	now_s = hubble_internal_utc_time_get() / 1000;
+
+	ret = hubble_next_pass_window_get(orbit, now_s, ground, &window);
+	if (ret < 0) {
+		HUBBLE_LOG_WARNING("Failed to get the next satellite pass");
+		return ret;
+	}
+
+	/* Transmit while the satellite is visible, an empty window keeps
+	 * the point pass and falls back to a window centered on it.
+	 */
+	if (window.end > window.start) {
+		window.pass.t = window.start;
+		window.pass.duration = window.end - window.start;
+	}
+
+	return _pass_enqueue(&request, mode, orbit, ground, &window.pass,
+			     now_s);
+}
+
+int hubble_sat_packet_region_pass_enqueue(
+	const struct hubble_sat_packet *packet,
+	enum hubble_sat_transmission_mode mode, uint8_t priority,
+	const struct orbit_info *orbit, const struct ground_region_info *region,
+	hubble_sat_packet_send_cb_t cb, void *user_data)
+{
+	int ret;
+	uint64_t now_s;
+	struct hubble_pass_info pass;
+	struct ground_info ground;
+	struct hubble_sat_port_tx_request request = {
+		.packet = packet,
+		.cb = cb,
+		.user_data = user_data,
+		.priority = priority,
+	};
+
+	if ((packet == NULL) || (orbit == NULL) || (region == NULL)) {
+		return -EINVAL;
+	}
+
+	if (!_sat_ready_get()) {
+		return -EAGAIN;
+	}
+
+	now_s = hubble_internal_utc_time_get() / 1000;
+
+	ret = hubble_next_pass_region_get(orbit, now_s, region, &pass);
+	if (ret < 0) {
+		HUBBLE_LOG_WARNING("Failed to get the next satellite pass");
+		return ret;
+	}
+
+	/* The link is estimated for the centre of the region */
+	ground.lat = region->lat_mid;
+	ground.lon = region->lon_mid;
+
+	return _pass_enqueue(&request, mode, orbit, &ground, &pass, now_s);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_EPHEMERIS */
+
+int hubble_sat_packet_send_cancel(const struct hubble_sat_packet *packet)
+{
+	if (packet == NULL) {
+		return -EINVAL;
+	}
+
+	return hubble_sat_port_packet_send_cancel(packet);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
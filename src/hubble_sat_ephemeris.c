@@ -4,6 +4,9 @@
 #include <string.h>
 #include <errno.h>
 
+#include "hubble_priv.h"
+#include "utils/macros.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -32,6 +35,35 @@ struct crossing_info {
 	double lon;
 };
 
+/* Latitude dependent terms of the crossings computation */
+struct latitude_info {
+	double rad;
+	double sin;
+	double tan;
+};
+
+/* Orbit inclination and latitude dependent terms of the crossings
+ * computation. They are the same for every orbit count.
+ */
+struct crossing_geometry {
+	double lat_rad;
+	double ra_asin;
+	/* sin and cos of the argument of latitude of the crossings */
+	double lam_sin[2];
+	double lam_cos[2];
+};
+
+/* Terms of a pass search. The ground dependent ones do not depend on
+ * the orbit, so they are computed once and shared by all searches over
+ * the same ground.
+ */
+struct ground_search_info {
+	const struct ground_info *ground;
+	struct latitude_info lat;
+	double lon_tol;
+	struct crossing_geometry geometry;
+};
+
 static const struct {
 	double radius;
 	double mu;
@@ -50,129 +82,45 @@ static const struct {
 
 #ifdef CONFIG_HUBBLE_SAT_NETWORK_SMALL
 
-static double _atan_poly(double u)
-{
-	double p = 0.1111111111111111;    /* 1/9 */
-	double t = u * u;
-
-	p = -0.14285714285714285 + t * p; /* -1/7 */
-	p = 0.2 + t * p;                  /* 1/5 */
-	p = -0.3333333333333333 + t * p;  /* -1/3 */
-	p = 1.0 + t * p;                  /* 1 */
-
-	return u * p;
-}
-
-static double _atan_small(double x)
-{
-	const double TAN22_5 = 0.41421356237309503; /* tan(pi/8) */
-	const double TAN67_5 = 2.414213562373095;   /* tan(3*pi/8) */
-
-	double ax = x < 0.0 ? -x : x;
-	double y;
-
-	if (ax <= TAN22_5) {
-		y = _atan_poly(ax);
-	} else if (ax >= TAN67_5) {
-		y = HUBBLE_PI_2 - _atan_poly(1.0 / ax);
-	} else {
-		double u = (ax - 1.0) / (ax + 1.0);
-		y = HUBBLE_PI_4 + _atan_poly(u);
-	}
-
-	return x < 0.0 ? -y : y;
-}
-
-/* Polynomial for sin on [-π/4, π/4], Horner form */
-static double _sin_poly(double z, double x)
-{
-	// z = x^2
-	return x *
-	       (1.0 +
-		z * (-1.66666666666666324348e-1 +
-		     z * (8.33333333332248946124e-3 +
-			  z * (-1.98412698298579493134e-4 +
-			       z * (2.75573137070700676789e-6 +
-				    z * (-2.50507602534068634195e-8 +
-					 z * (1.58969099521155010221e-10)))))));
-}
-
-/* Polynomial for cos on [-π/4, π/4] */
-static double _cos_poly(double z)
+/* Rounding without libm. The values are times and angles far below
+ * 2^63, so the conversion to an integer does not overflow.
+ */
+static double _trunc_small(double x)
 {
-	return 1.0 +
-	       z * (-0.5 +
-		    z * (4.16666666666666019037e-2 +
-			 z * (-1.38888888888741095749e-3 +
-			      z * (2.48015872894767294178e-5 +
-				   z * (-2.75573143513906633035e-7 +
-					z * (2.08757232129817482790e-9 +
-					     z * (-1.13596475577881948265e-11)))))));
+	return (double)(int64_t)x;
 }
 
-/* Range reduction: reduce x to quadrant and remainder in [-π/4, π/4] */
-static void _range_reduce(double x, int *q, double *r)
+static double _floor_small(double x)
 {
-	/* Reduce x/π to integer multiple of 0.5 */
-	double n = nearbyint(
-		x * (0.5 * HUBBLE_INV_PI)); /* round to nearest multiple of π/2 */
+	double t = _trunc_small(x);
 
-	*q = (int)n;
-	*r = x - n * HUBBLE_PI_2;
+	return (t > x) ? (t - 1.0) : t;
 }
 
-static double _sin_small(double x)
+static double _ceil_small(double x)
 {
-	int q;
-	double r, z;
-
-	_range_reduce(x, &q, &r);
-	z = r * r;
+	double t = _trunc_small(x);
 
-	switch (q & 3) {
-	case 0:
-		return _sin_poly(z, r);
-	case 1:
-		return _cos_poly(z);
-	case 2:
-		return -_sin_poly(z, r);
-	default:
-		return -_cos_poly(z);
-	}
+	return (t < x) ? (t + 1.0) : t;
 }
 
-static double _cos_small(double x)
+/* Rounds halfway cases away from zero, like lround() */
+static int64_t _lround_small(double x)
 {
-	int q;
-	double r, z;
-	_range_reduce(x, &q, &r);
-
-	z = r * r;
-
-	switch (q & 3) {
-	case 0:
-		return _cos_poly(z);
-	case 1:
-		return -_sin_poly(z, r);
-	case 2:
-		return -_cos_poly(z);
-	default:
-		return _sin_poly(z, r);
-	}
+	return (int64_t)((x >= 0.0) ? (x + 0.5) : (x - 0.5));
 }
 
 static double _fmod_small(double x, double y)
 {
-	double q, qi;
+	double q;
 
 	if (y == 0.0) {
 		return NAN; /* domain error, same as standard fmod */
 	}
 
 	q = (x / y);
-	qi = (q >= 0.0) ? floor(q) : ceil(q);
 
-	return x - qi * y;
+	return x - _trunc_small(q) * y;
 }
 
 static double _sqrt_small(double x)
@@ -235,387 +183,1357 @@ static double _sqrt_small(double x)
 	return s;
 }
 
-static double _tan_small(double x)
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SMALL_FLOAT
+
+/* π/2 split in three parts for the range reduction (Cody-Waite). The
+ * first two have few significant bits, so their products with the
+ * quadrant are exact in single precision.
+ */
+#define HUBBLE_PI_2_F1 1.5703125f
+#define HUBBLE_PI_2_F2 4.837512969970703125e-4f
+#define HUBBLE_PI_2_F3 7.54978995489188216e-8f
+#define HUBBLE_2_PI_F  0.636619772367581343f /* 2 / PI */
+
+/* Single precision polynomial for sin on [-π/4, π/4] */
+static float _sinf_poly(float z, float x)
 {
-	return _sin_small(x) / _cos_small(x);
+	// z = x^2
+	return x + (x * z *
+		    (-1.6666654611e-1f +
+		     z * (8.3321608736e-3f + z * (-1.9515295891e-4f))));
 }
 
-static inline double _asin_small(double x)
+/* Single precision polynomial for cos on [-π/4, π/4] */
+static float _cosf_poly(float z)
 {
-	double denom;
-
-	/* clamp to [-1,1] to avoid NaNs from rounding */
-	if (x > 1.0) {
-		x = 1.0;
-	}
-
-	if (x < -1.0) {
-		x = -1.0;
-	}
-
-	/* identity: asin(x) = atan( x / sqrt(1 - x^2) ) */
-	denom = _sqrt_small(fmax(0.0, 1.0 - x * x));
-	if (denom == 0.0) { // x is +-1
-		return copysign(HUBBLE_PI_2, x);
-	}
-
-	return _atan_small(x / denom);
+	return 1.0f - (0.5f * z) +
+	       (z * z *
+		(4.166664568298827e-2f +
+		 z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f)));
 }
 
-#define _cos  _cos_small
-#define _sin  _sin_small
-#define _sqrt _sqrt_small
-#define _atan _atan_small
-#define _asin _asin_small
-#define _tan  _tan_small
-#define _fmod _fmod_small
-
-#else
-
-#define _cos  cos
-#define _sin  sin
-#define _sqrt sqrt
-#define _atan atan
-#define _asin asin
-#define _tan  tan
-#define _fmod fmod
+/* Range reduction: reduce x to quadrant and remainder in [-π/4, π/4] */
+static void _range_reducef(float x, int *q, float *r)
+{
+	/* round to nearest multiple of π/2 */
+	float n = (float)(int)((x * HUBBLE_2_PI_F) +
+			       ((x < 0.0f) ? -0.5f : 0.5f));
 
-#endif /* CONFIG_HUBBLE_SAT_NETWORK_SMALL */
+	*q = (int)n;
+	*r = ((x - (n * HUBBLE_PI_2_F1)) - (n * HUBBLE_PI_2_F2)) -
+	     (n * HUBBLE_PI_2_F3);
+}
 
-static double _signed_fmod(double x, double y)
+static float _sinf_small(float x)
 {
-	double ret;
+	int q;
+	float r, z;
 
-	if (y == 0.0) {
-		return NAN;
-	}
+	_range_reducef(x, &q, &r);
+	z = r * r;
 
-	ret = _fmod(x, y);
-	if ((ret != 0) && ((y < 0 && ret > 0) || (y > 0 && ret < 0))) {
-		ret += y;
+	switch (q & 3) {
+	case 0:
+		return _sinf_poly(z, r);
+	case 1:
+		return _cosf_poly(z);
+	case 2:
+		return -_sinf_poly(z, r);
+	default:
+		return -_cosf_poly(z);
 	}
-
-	return ret;
 }
 
-/* Normalizes an angle to the range [0, 2π) */
-static double _zero_to_2pi(double angle)
+static float _cosf_small(float x)
 {
-	if (angle < 0.0) {
-		return angle + (2.00 * M_PI);
-	}
+	int q;
+	float r, z;
 
-	return _fmod(angle, (2.00 * M_PI));
-}
+	_range_reducef(x, &q, &r);
+	z = r * r;
 
-/* Normalizes an angle to the range [-180, 180) */
-static double _minus_180_to_180(double angle)
-{
-	return _signed_fmod(angle + HUBBLE_PI_DEGREES, HUBBLE_TWO_PI_DEGREES) -
-	       HUBBLE_PI_DEGREES;
+	switch (q & 3) {
+	case 0:
+		return _cosf_poly(z);
+	case 1:
+		return -_sinf_poly(z, r);
+	case 2:
+		return -_cosf_poly(z);
+	default:
+		return _sinf_poly(z, r);
+	}
 }
 
-static double _zero_to_360(double angle)
+static void _sincosf_small(float x, float *s, float *c)
 {
-	return _signed_fmod(angle, HUBBLE_TWO_PI_DEGREES);
+	int q;
+	float r, z, sp, cp;
+
+	_range_reducef(x, &q, &r);
+	z = r * r;
+	sp = _sinf_poly(z, r);
+	cp = _cosf_poly(z);
+
+	switch (q & 3) {
+	case 0:
+		*s = sp;
+		*c = cp;
+		break;
+	case 1:
+		*s = cp;
+		*c = -sp;
+		break;
+	case 2:
+		*s = -sp;
+		*c = -cp;
+		break;
+	default:
+		*s = -cp;
+		*c = sp;
+		break;
+	}
 }
 
-/* Computes mean anomaly from true anomaly (theta) */
-static double _anomaly_from_theta_mean(double e, double theta)
+static float _atanf_small(float x)
 {
-	double E, me;
-
-	if (e == 0.0) {
-		return theta;
+	float ax = (x < 0.0f) ? -x : x;
+	float y = 0.0f;
+	float z;
+
+	if (ax > 2.414213562373095f) { /* tan(3*pi/8) */
+		y = (float)HUBBLE_PI_2;
+		ax = -1.0f / ax;
+	} else if (ax > 0.4142135623730950f) { /* tan(pi/8) */
+		y = (float)HUBBLE_PI_4;
+		ax = (ax - 1.0f) / (ax + 1.0f);
 	}
 
-	E = 2 * _atan(_sqrt((1 - e) / (1 + e)) * _tan(theta / 2));
-	me = E - e * _sin(E);
+	z = ax * ax;
+	y += (((((8.05374449538e-2f * z) - 1.38776856032e-1f) * z +
+		1.99777106478e-1f) *
+		       z -
+	       3.33329491539e-1f) *
+	      z * ax) +
+	     ax;
 
-	return _zero_to_2pi(me);
+	return (x < 0.0f) ? -y : y;
 }
 
-/* Gets the time of the ascending node for a given orbit count */
-static uint64_t _anode_time_get(const struct orbit_info *info, int count)
+static float _atan2f_small(float y, float x)
 {
-	double dt;
+	if (x > 0.0f) {
+		return _atanf_small(y / x);
+	}
 
-	if (info->ndot == 0.0) {
-		dt = count / info->n0;
-	} else {
-		dt = (_sqrt(info->n0 * info->n0 + 2 * info->ndot * count) -
-		      info->n0) /
-		     info->ndot;
+	if (x < 0.0f) {
+		return _atanf_small(y / x) +
+		       ((y < 0.0f) ? -(float)M_PI : (float)M_PI);
+	}
+
+	if (y == 0.0f) {
+		return 0.0f;
 	}
 
-	return (uint64_t)(info->t0 + lround(dt));
+	return (y < 0.0f) ? -(float)HUBBLE_PI_2 : (float)HUBBLE_PI_2;
 }
 
-/* Gets the orbit count at a given time */
-static int _orbit_count_get(const struct orbit_info *info, uint64_t t)
+static float _sqrtf_small(float x)
 {
-	int64_t dt = t - info->t0;
+	union {
+		float f;
+		uint32_t u;
+	} v;
+	float y;
 
-	return (int)((info->n0 * dt) + (0.5 * info->ndot) * dt * dt);
-}
+	if (x <= 0.0f) {
+		return (x == 0.0f) ? 0.0f : (0.0f / 0.0f);
+	}
 
-/* Gets longitude from right ascension and time */
-static double _longitude_get(double ra, uint64_t t)
-{
-	int64_t dt = t - earth.teme_ref_datetime_2027;
-	double lon_rad =
-		ra - earth.teme_angle_2027 - earth.earth_rotation_rate * dt;
+	/* Inverse sqrt seed and two Newton steps */
+	v.f = x;
+	v.u = 0x5f3759dfU - (v.u >> 1);
+	y = v.f;
+	y = y * (1.5f - (0.5f * x * y * y));
+	y = y * (1.5f - (0.5f * x * y * y));
 
-	return _minus_180_to_180(_RAD2DEG(lon_rad));
+	return x * y;
 }
 
-/* Gets the crossings for a target latitude */
-static int _tll_crossings_get(const struct orbit_info *orbit, double tll,
-			      int orbit_count, struct crossing_info result[2])
+static float _asinf_small(float x)
 {
-	double latrad = _DEG2RAD(tll);
-	double inclination = _DEG2RAD(orbit->inclination);
-	double lam1, lam2, me0, me1, me2, ra1, ra2, aop, orbit_period, raan;
-	uint64_t anode_time;
-	int64_t dt_anode;
-
-	if ((inclination < 0) || (inclination > M_PI)) {
-		return -1;
-	}
-
-	if (fabs(_sin(inclination)) <= fabs(_sin(latrad))) {
-		return -1;
-	}
+	float denom;
 
-	anode_time = _anode_time_get(orbit, orbit_count);
-	dt_anode = (int64_t)anode_time - orbit->t0;
-	raan = orbit->raan0 + (orbit->raandot * dt_anode);
-	aop = orbit->aop0 + (orbit->aopdot * dt_anode);
-	orbit_period = 1.0 / (orbit->n0 + (orbit->ndot * dt_anode));
-	if (latrad >= 0) {
-		ra1 = raan + _asin(_tan(latrad) / _tan(inclination));
-		ra2 = raan + M_PI - _asin(_tan(latrad) / _tan(inclination));
-	} else {
-		ra2 = raan + _asin(_tan(latrad) / _tan(inclination));
-		ra1 = raan + M_PI - _asin(_tan(latrad) / _tan(inclination));
+	/* clamp to [-1,1] to avoid NaNs from rounding */
+	if (x > 1.0f) {
+		x = 1.0f;
 	}
 
-	if (latrad >= 0) {
-		lam1 = _asin(_sin(latrad) / _sin(inclination));
-		lam2 = M_PI - lam1;
-	} else {
-		lam1 = M_PI - _asin(_sin(latrad) / _sin(inclination));
-		lam2 = (3 * M_PI) - lam1;
+	if (x < -1.0f) {
+		x = -1.0f;
 	}
 
-	if ((lam1 < 0) || (lam1 >= (2 * M_PI))) {
-		return -1;
+	/* identity: asin(x) = atan( x / sqrt(1 - x^2) ) */
+	denom = _sqrtf_small(1.0f - (x * x));
+	if (denom == 0.0f) {
+		return (x < 0.0f) ? -(float)HUBBLE_PI_2 : (float)HUBBLE_PI_2;
 	}
 
-	if ((lam2 < 0) || (lam2 >= (2 * M_PI))) {
-		return -1;
-	}
+	return _atanf_small(x / denom);
+}
 
-	if (lam1 >= lam2) {
-		return -1;
-	}
+#define _cos       _cosf_small
+#define _sin       _sinf_small
+#define _sincos    _sincosf_small
+#define _atan      _atanf_small
+#define _atan2     _atan2f_small
+#define _asin      _asinf_small
+#define _sqrt_real _sqrtf_small
 
-	me0 = _anomaly_from_theta_mean(orbit->eccentricity, -aop);
-	me1 = _anomaly_from_theta_mean(orbit->eccentricity, lam1 - aop);
-	me2 = _anomaly_from_theta_mean(orbit->eccentricity, lam2 - aop);
+#else
 
-	result[0].t =
-		anode_time +
-		(uint64_t)lround(_signed_fmod(
-			orbit_period * (me1 - me0) / (2 * M_PI), orbit_period));
-	result[0].lon = _longitude_get(ra1, result[0].t);
-	result[1].t =
-		anode_time +
-		(uint64_t)lround(_signed_fmod(
-			orbit_period * (me2 - me0) / (2 * M_PI), orbit_period));
-	result[1].lon = _longitude_get(ra2, result[1].t);
+/* Minimax polynomials for sin and cos on [-π/4, π/4] and for atan on
+ * [-tan(π/8), tan(π/8)]. Lower accuracies use lower degrees.
+ */
+#if defined(CONFIG_HUBBLE_SAT_NETWORK_SMALL_ACCURACY_LOW)
 
-	return 0;
+/* Max relative error: sin 1.8e-6, cos 6.7e-8, atan 6.4e-7 */
+static double _sin_poly(double z, double x)
+{
+	// z = x^2
+	return x + (x * z *
+		    (-1.66634585335033796482e-1 +
+		     z * 8.16460872812585077616e-3));
 }
 
-static double _lon_tolerance_get(double lat)
+static double _cos_poly(double z)
 {
-	double A, C, b, B;
+	return 1.0 - (0.5 * z) +
+	       (z * z *
+		(4.16612786259281681658e-2 + z * -1.36524502114906657715e-3));
+}
 
-	A = _DEG2RAD(HUBBLE_ELEVATION_ANGLE_TOLERANCE + 90);
+static double _atan_poly(double u)
+{
+	double t = u * u;
+
+	return u + (u * t *
+		    (-3.33256149590236786469e-1 +
+		     t * (1.97161589615497485303e-1 +
+			  t * -1.12335906473732671101e-1)));
+}
+
+#elif defined(CONFIG_HUBBLE_SAT_NETWORK_SMALL_ACCURACY_MEDIUM)
+
+/* Max relative error: sin 3.6e-9, cos 9.5e-11, atan 6.6e-10 */
+static double _sin_poly(double z, double x)
+{
+	// z = x^2
+	return x + (x * z *
+		    (-1.66666549437023428305e-1 +
+		     z * (8.33217814617796453249e-3 +
+			  z * -1.95172989840216697400e-4)));
+}
+
+static double _cos_poly(double z)
+{
+	return 1.0 - (0.5 * z) +
+	       (z * z *
+		(4.16666468664446689166e-2 +
+		 z * (-1.38873675157821793020e-3 +
+		      z * 2.44384515951044279126e-5)));
+}
+
+static double _atan_poly(double u)
+{
+	double t = u * u;
+
+	return u + (u * t *
+		    (-3.33333155051640933749e-1 +
+		     t * (1.99984894330455922749e-1 +
+			  t * (-1.42438486934411620900e-1 +
+			       t * (1.05960013151152361149e-1 +
+				    t * -6.08345288566651192560e-2)))));
+}
+
+#else
+
+/* Polynomial for sin on [-π/4, π/4], Horner form */
+static double _sin_poly(double z, double x)
+{
+	// z = x^2
+	return x *
+	       (1.0 +
+		z * (-1.66666666666666324348e-1 +
+		     z * (8.33333333332248946124e-3 +
+			  z * (-1.98412698298579493134e-4 +
+			       z * (2.75573137070700676789e-6 +
+				    z * (-2.50507602534068634195e-8 +
+					 z * (1.58969099521155010221e-10)))))));
+}
+
+/* Polynomial for cos on [-π/4, π/4] */
+static double _cos_poly(double z)
+{
+	return 1.0 +
+	       z * (-0.5 +
+		    z * (4.16666666666666019037e-2 +
+			 z * (-1.38888888888741095749e-3 +
+			      z * (2.48015872894767294178e-5 +
+				   z * (-2.75573143513906633035e-7 +
+					z * (2.08757232129817482790e-9 +
+					     z * (-1.13596475577881948265e-11)))))));
+}
+
+/* Max relative error 2.7e-14 */
+static double _atan_poly(double u)
+{
+	double t = u * u;
+
+	return u + (u * t *
+		    (-3.33333333316972548780e-1 +
+		     t * (1.99999996856383604501e-1 +
+			  t * (-1.42856935971493884651e-1 +
+			       t * (1.11104500190594498690e-1 +
+				    t * (-9.07913820236635233404e-2 +
+					 t * (7.56854526410540664461e-2 +
+					      t * (-5.89108155609785273468e-2 +
+						   t * 3.08951055838873039783e-2))))))));
+}
+
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SMALL_ACCURACY_LOW */
+
+static double _atan_small(double x)
+{
+	const double TAN22_5 = 0.41421356237309503; /* tan(pi/8) */
+	const double TAN67_5 = 2.414213562373095;   /* tan(3*pi/8) */
+
+	double ax = x < 0.0 ? -x : x;
+	double y;
+
+	if (ax <= TAN22_5) {
+		y = _atan_poly(ax);
+	} else if (ax >= TAN67_5) {
+		y = HUBBLE_PI_2 - _atan_poly(1.0 / ax);
+	} else {
+		double u = (ax - 1.0) / (ax + 1.0);
+		y = HUBBLE_PI_4 + _atan_poly(u);
+	}
+
+	return x < 0.0 ? -y : y;
+}
+
+/* Range reduction: reduce x to quadrant and remainder in [-π/4, π/4] */
+static void _range_reduce(double x, int *q, double *r)
+{
+	/* Reduce x/π to integer multiple of 0.5 */
+	double n = (double)_lround_small(
+		x * (2 * HUBBLE_INV_PI)); /* round to nearest multiple of π/2 */
+
+	*q = (int)n;
+	*r = x - n * HUBBLE_PI_2;
+}
+
+static double _sin_small(double x)
+{
+	int q;
+	double r, z;
+
+	_range_reduce(x, &q, &r);
+	z = r * r;
+
+	switch (q & 3) {
+	case 0:
+		return _sin_poly(z, r);
+	case 1:
+		return _cos_poly(z);
+	case 2:
+		return -_sin_poly(z, r);
+	default:
+		return -_cos_poly(z);
+	}
+}
+
+static double _cos_small(double x)
+{
+	int q;
+	double r, z;
+	_range_reduce(x, &q, &r);
+
+	z = r * r;
+
+	switch (q & 3) {
+	case 0:
+		return _cos_poly(z);
+	case 1:
+		return -_sin_poly(z, r);
+	case 2:
+		return -_cos_poly(z);
+	default:
+		return _sin_poly(z, r);
+	}
+}
+
+static void _sincos_small(double x, double *s, double *c)
+{
+	int q;
+	double r, z, sp, cp;
+
+	_range_reduce(x, &q, &r);
+	z = r * r;
+	sp = _sin_poly(z, r);
+	cp = _cos_poly(z);
+
+	switch (q & 3) {
+	case 0:
+		*s = sp;
+		*c = cp;
+		break;
+	case 1:
+		*s = cp;
+		*c = -sp;
+		break;
+	case 2:
+		*s = -sp;
+		*c = -cp;
+		break;
+	default:
+		*s = -cp;
+		*c = sp;
+		break;
+	}
+}
+
+static double _atan2_small(double y, double x)
+{
+	if (x > 0.0) {
+		return _atan_small(y / x);
+	}
+
+	if (x < 0.0) {
+		return _atan_small(y / x) + copysign(M_PI, y);
+	}
+
+	if (y == 0.0) {
+		return 0.0;
+	}
+
+	return copysign(HUBBLE_PI_2, y);
+}
+
+static inline double _asin_small(double x)
+{
+	double denom;
+
+	/* clamp to [-1,1] to avoid NaNs from rounding */
+	if (x > 1.0) {
+		x = 1.0;
+	}
+
+	if (x < -1.0) {
+		x = -1.0;
+	}
+
+	/* identity: asin(x) = atan( x / sqrt(1 - x^2) ) */
+	denom = _sqrt_small(HUBBLE_MAX(0.0, 1.0 - x * x));
+	if (denom == 0.0) { // x is +-1
+		return copysign(HUBBLE_PI_2, x);
+	}
+
+	return _atan_small(x / denom);
+}
+
+#define _cos    _cos_small
+#define _sin    _sin_small
+#define _sincos _sincos_small
+#define _atan   _atan_small
+#define _atan2  _atan2_small
+#define _asin   _asin_small
+
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SMALL_FLOAT */
+
+#define _sqrt   _sqrt_small
+#define _fmod   _fmod_small
+#define _floor  _floor_small
+#define _ceil   _ceil_small
+#define _lround _lround_small
+
+#else
+
+static void _sincos_math(double x, double *s, double *c)
+{
+	*s = sin(x);
+	*c = cos(x);
+}
+
+#define _cos    cos
+#define _sin    sin
+#define _sincos _sincos_math
+#define _sqrt   sqrt
+#define _atan   atan
+#define _atan2  atan2
+#define _asin   asin
+#define _fmod   fmod
+#define _floor  floor
+#define _ceil   ceil
+#define _lround lround
+
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SMALL */
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SMALL_FLOAT
+/* Type of the angles within an orbit, which do not need more than
+ * single precision. Times and angles accumulated over many orbits
+ * (Earth rotation, precession) are kept in double precision.
+ */
+typedef float _real_t;
+#else
+typedef double _real_t;
+#define _sqrt_real _sqrt
+#endif
+
+static double _signed_fmod(double x, double y)
+{
+	double ret;
+
+	if (y == 0.0) {
+		return NAN;
+	}
+
+	ret = _fmod(x, y);
+	if ((ret != 0) && ((y < 0 && ret > 0) || (y > 0 && ret < 0))) {
+		ret += y;
+	}
+
+	return ret;
+}
+
+/* Normalizes an angle to the range [0, 2π) */
+static double _zero_to_2pi(double angle)
+{
+	if (angle < 0.0) {
+		return angle + (2.00 * M_PI);
+	}
+
+	return _fmod(angle, (2.00 * M_PI));
+}
+
+/* Normalizes an angle to the range [-180, 180) */
+static double _minus_180_to_180(double angle)
+{
+	return _signed_fmod(angle + HUBBLE_PI_DEGREES, HUBBLE_TWO_PI_DEGREES) -
+	       HUBBLE_PI_DEGREES;
+}
+
+/* Computes mean anomaly from the sine and cosine of the true anomaly
+ * (theta). beta is sqrt(1 - e^2).
+ */
+static double _anomaly_from_theta_mean(_real_t e, _real_t beta,
+				       _real_t theta_sin, _real_t theta_cos)
+{
+	_real_t E_sin, E, me;
+
+	/* sin(E) = beta * sin(theta) / (1 + e * cos(theta))
+	 * cos(E) = (e + cos(theta)) / (1 + e * cos(theta))
+	 */
+	E_sin = beta * theta_sin;
+	E = _atan2(E_sin, e + theta_cos);
+	me = E - (e * E_sin / (1 + (e * theta_cos)));
+
+	return _zero_to_2pi(me);
+}
+
+/* Gets the time of the ascending node for a given orbit count */
+static uint64_t _anode_time_get(const struct orbit_info *info, int count)
+{
+	double dt;
+
+	if (info->ndot == 0.0) {
+		dt = count / info->n0;
+	} else {
+		dt = (_sqrt(info->n0 * info->n0 + 2 * info->ndot * count) -
+		      info->n0) /
+		     info->ndot;
+	}
+
+	return (uint64_t)(info->t0 + _lround(dt));
+}
+
+/* Gets the orbit count at a given time */
+static int _orbit_count_get(const struct orbit_info *info, uint64_t t)
+{
+	int64_t dt = t - info->t0;
+
+	return (int)((info->n0 * dt) + (0.5 * info->ndot) * dt * dt);
+}
+
+/* Gets longitude from right ascension and time */
+static double _longitude_get(double ra, uint64_t t)
+{
+	int64_t dt = t - earth.teme_ref_datetime_2027;
+	double lon_rad =
+		ra - earth.teme_angle_2027 - earth.earth_rotation_rate * dt;
+
+	return _minus_180_to_180(_RAD2DEG(lon_rad));
+}
+
+static void _latitude_info_get(double lat, struct latitude_info *info)
+{
+	_real_t lat_sin, lat_cos;
+
+	info->rad = _DEG2RAD(lat);
+	_sincos(info->rad, &lat_sin, &lat_cos);
+	info->sin = lat_sin;
+	info->tan = lat_sin / lat_cos;
+}
+
+/* Gets the terms of the crossings computation that only depend on the
+ * orbit inclination and the target latitude.
+ */
+static int _crossing_geometry_get(const struct orbit_info *orbit,
+				  const struct latitude_info *tll,
+				  struct crossing_geometry *geometry)
+{
+	double latrad = tll->rad;
+	double inclination = _DEG2RAD(orbit->inclination);
+	double lam1, lam2;
+	_real_t incl_sin, incl_cos, lam_sin, lam_cos;
+
+	if ((inclination < 0) || (inclination > M_PI)) {
+		return -1;
+	}
+
+	_sincos(inclination, &incl_sin, &incl_cos);
+	if (fabs(incl_sin) <= fabs(tll->sin)) {
+		return -1;
+	}
+
+	if (latrad >= 0) {
+		lam1 = _asin(tll->sin / incl_sin);
+		lam2 = M_PI - lam1;
+	} else {
+		lam1 = M_PI - _asin(tll->sin / incl_sin);
+		lam2 = (3 * M_PI) - lam1;
+	}
+
+	if ((lam1 < 0) || (lam1 >= (2 * M_PI))) {
+		return -1;
+	}
+
+	if ((lam2 < 0) || (lam2 >= (2 * M_PI))) {
+		return -1;
+	}
+
+	if (lam1 >= lam2) {
+		return -1;
+	}
+
+	geometry->lat_rad = latrad;
+	geometry->ra_asin = _asin(tll->tan * incl_cos / incl_sin);
+	_sincos(lam1, &lam_sin, &lam_cos);
+	geometry->lam_sin[0] = lam_sin;
+	geometry->lam_cos[0] = lam_cos;
+	_sincos(lam2, &lam_sin, &lam_cos);
+	geometry->lam_sin[1] = lam_sin;
+	geometry->lam_cos[1] = lam_cos;
+
+	return 0;
+}
+
+/* Gets the crossings of an orbit count from its geometry */
+static void _crossings_get(const struct orbit_info *orbit,
+			   const struct crossing_geometry *geometry,
+			   int orbit_count, struct crossing_info result[2])
+{
+	double me0, me1, me2, ra1, ra2, aop, orbit_period, raan;
+	_real_t e, beta, aop_sin, aop_cos;
+	uint64_t anode_time;
+	int64_t dt_anode;
+
+	anode_time = _anode_time_get(orbit, orbit_count);
+	dt_anode = (int64_t)anode_time - orbit->t0;
+	raan = orbit->raan0 + (orbit->raandot * dt_anode);
+	aop = orbit->aop0 + (orbit->aopdot * dt_anode);
+	orbit_period = 1.0 / (orbit->n0 + (orbit->ndot * dt_anode));
+	if (geometry->lat_rad >= 0) {
+		ra1 = raan + geometry->ra_asin;
+		ra2 = raan + M_PI - geometry->ra_asin;
+	} else {
+		ra2 = raan + geometry->ra_asin;
+		ra1 = raan + M_PI - geometry->ra_asin;
+	}
+
+	/* The true anomalies are -aop, lam1 - aop and lam2 - aop, their
+	 * sin and cos come from the ones of aop and the geometry.
+	 */
+	e = orbit->eccentricity;
+	beta = _sqrt_real(1 - (e * e));
+	_sincos(aop, &aop_sin, &aop_cos);
+
+	me0 = _anomaly_from_theta_mean(e, beta, -aop_sin, aop_cos);
+	me1 = _anomaly_from_theta_mean(
+		e, beta,
+		(geometry->lam_sin[0] * aop_cos) -
+			(geometry->lam_cos[0] * aop_sin),
+		(geometry->lam_cos[0] * aop_cos) +
+			(geometry->lam_sin[0] * aop_sin));
+	me2 = _anomaly_from_theta_mean(
+		e, beta,
+		(geometry->lam_sin[1] * aop_cos) -
+			(geometry->lam_cos[1] * aop_sin),
+		(geometry->lam_cos[1] * aop_cos) +
+			(geometry->lam_sin[1] * aop_sin));
+
+	result[0].t =
+		anode_time +
+		(uint64_t)_lround(_signed_fmod(
+			orbit_period * (me1 - me0) / (2 * M_PI), orbit_period));
+	result[0].lon = _longitude_get(ra1, result[0].t);
+	result[1].t =
+		anode_time +
+		(uint64_t)_lround(_signed_fmod(
+			orbit_period * (me2 - me0) / (2 * M_PI), orbit_period));
+	result[1].lon = _longitude_get(ra2, result[1].t);
+}
+
+/* Gets the footprint of the satellite, as the angle at the Earth centre
+ * between the ground and the satellite when it is
+ * HUBBLE_ELEVATION_ANGLE_TOLERANCE degrees above the horizon.
+ */
+static double _footprint_angle_get(void)
+{
+	double A, C, b;
+
+	A = _DEG2RAD(HUBBLE_ELEVATION_ANGLE_TOLERANCE + 90);
 
 	C = _asin(earth.radius * _sin(A) / HUBBLE_SAT_ELEVATION);
 	b = earth.radius * _cos(M_PI - _asin(HUBBLE_SAT_ELEVATION *
 					     (_sin(C) / earth.radius))) +
 	    (HUBBLE_SAT_ELEVATION * (_cos(C)));
-	B = _asin(b * sin(C) / earth.radius);
+
+	return _asin(b * _sin(C) / earth.radius);
+}
+
+static double _lon_tolerance_get(double lat)
+{
+	double B = _footprint_angle_get();
 
 	return _RAD2DEG(_asin((earth.radius * _sin(B)) /
 			      (earth.radius * _cos(_DEG2RAD(lat)))));
 }
 
-/*
- * Helper function to calculate the next pass for ascending or
- * descending crossings
+/* Max number of orbits, and Earth turns, a pass search looks ahead */
+#define _PASS_SEARCH_ORBITS_MAX 16384
+#define _PASS_SEARCH_TURNS_MAX  1024
+
+/* Max number of orbits a prediction jumps before the crossings are
+ * evaluated again, and margin, in degrees, on the predicted longitude
+ * of a crossing, so crossings predicted close to the window are
+ * evaluated.
  */
-static int _next_pass_get(const struct orbit_info *orbit, bool ascending,
-			  double delta_lon, double lon_tol,
-			  const struct ground_info *ground,
-			  struct crossing_info crossings[2],
-			  struct hubble_pass_info *pass, uint64_t t)
+#define _PASS_SEARCH_ORBITS_STEP 1024
+#define _PASS_SEARCH_LON_MARGIN  1.0
 
+/* Gets the longitude, in degrees, the crossings move west every orbit.
+ * It is the Earth rotation, minus the nodal precession, during an orbit.
+ */
+static double _orbit_lon_drift_get(const struct orbit_info *orbit,
+				   uint64_t t)
 {
-	int orbit_count, index;
-	double dt = _DEG2RAD(delta_lon) / earth.earth_rotation_rate;
+	int64_t dt = (int64_t)t - orbit->t0;
+	double orbit_period = 1.0 / (orbit->n0 + (orbit->ndot * dt));
 
-	/* Determine the index for ascending or descending crossing */
-	index = ascending ? 0 : 1;
-	orbit_count = _orbit_count_get(
-		orbit, crossings[index].t + (uint64_t)lround(dt));
+	return _RAD2DEG((earth.earth_rotation_rate - orbit->raandot) *
+			orbit_period);
+}
 
-	/* Get the crossings for the updated orbit count */
-	if (_tll_crossings_get(orbit, ground->lat, orbit_count, crossings) != 0) {
-		return -1;
-	}
+/* Predicts, without evaluating crossings, the first orbit in
+ * (lower, upper) whose crossing is within the tolerance, given the
+ * offset of the crossing of lower to the ground. Returns upper if
+ * there is none.
+ *
+ * The crossings move west with the Earth rotation, minus the nodal
+ * precession, so the time the crossing of lower takes to reach the
+ * window on every Earth turn is known. The orbit counts at those times
+ * come from the mean motion, which accounts for the decay of the orbit.
+ */
+static int _window_orbit_predict(const struct orbit_info *orbit, int lower,
+				 int upper, double offset, double lon_tol)
+{
+	double rate = _RAD2DEG(earth.earth_rotation_rate - orbit->raandot);
+	double lower_dt = (double)(int64_t)(_anode_time_get(orbit, lower) -
+					    orbit->t0);
+	double enter_dt, leave_dt, first, last;
+
+	for (int turn = 0; turn < _PASS_SEARCH_TURNS_MAX; turn++) {
+		enter_dt = lower_dt + ((offset - lon_tol +
+					(turn * HUBBLE_TWO_PI_DEGREES)) /
+				       rate);
+		leave_dt = lower_dt + ((offset + lon_tol +
+					(turn * HUBBLE_TWO_PI_DEGREES)) /
+				       rate);
+
+		first = _ceil((orbit->n0 * enter_dt) +
+			     (0.5 * orbit->ndot * enter_dt * enter_dt));
+		last = _floor((orbit->n0 * leave_dt) +
+			     (0.5 * orbit->ndot * leave_dt * leave_dt));
+
+		first = HUBBLE_MAX(first, lower + 1);
+		if (first >= upper) {
+			return upper;
+		}
 
-	/* Iterate until a valid pass is found */
-	while (pass->t == 0 &&
-	       (HUBBLE_TWO_PI_DEGREES - _zero_to_360(ground->lon - lon_tol -
-						     crossings[index].lon) <
-		HUBBLE_PI_DEGREES)) {
-		if ((fabs(_minus_180_to_180(crossings[index].lon - ground->lon)) <=
-		     lon_tol) &&
-		    (crossings[index].t > t)) {
-			pass->t = crossings[index].t;
-			pass->lon = crossings[index].lon;
-			pass->ascending = (ascending) ? ground->lat > 0
-						      : ground->lat <= 0;
-		} else {
-			orbit_count++;
-			if (_tll_crossings_get(orbit, ground->lat, orbit_count,
-					       crossings) != 0) {
-				return -1;
-			}
+		if (first <= last) {
+			return (int)first;
 		}
 	}
 
-	return 0;
+	return upper;
 }
 
-static int _pass_get(const struct orbit_info *orbit, uint64_t t,
-		     const struct ground_info *ground, double lon_tol,
-		     struct hubble_pass_info *pass)
+static bool _crossing_in_window(const struct crossing_info *crossing,
+				const struct ground_search_info *search)
 {
-	struct crossing_info crossings[2];
-	int orbit_count;
+	return fabs(_minus_180_to_180(crossing->lon - search->ground->lon)) <=
+	       search->lon_tol;
+}
 
-	orbit_count = _orbit_count_get(orbit, t);
-	if (orbit_count < 0) {
-		return -1;
-	}
+/*
+ * Gets the first orbit after the given one, and not after limit, whose
+ * crossing (ascending or descending by index) is within the longitude
+ * tolerance. The orbit to jump to is predicted from the drift of the
+ * crossings and then refined with the actual crossings, so only a few
+ * crossings are evaluated regardless of how far the pass is.
+ */
+static int _window_orbit_get(const struct orbit_info *orbit, int index,
+			     const struct ground_search_info *search, int limit,
+			     int *orbit_count, struct crossing_info crossings[2])
+{
+	struct crossing_info previous[2];
+	double drift, offset;
+	int lower = *orbit_count;
+	int count;
+
+	while (lower < limit) {
+		offset = _minus_180_to_180(crossings[index].lon -
+					   search->ground->lon);
+		count = _window_orbit_predict(
+			orbit, lower,
+			HUBBLE_MIN(lower + _PASS_SEARCH_ORBITS_STEP, limit),
+			offset, search->lon_tol + _PASS_SEARCH_LON_MARGIN);
+
+		_crossings_get(orbit, &search->geometry, count, crossings);
+		drift = _orbit_lon_drift_get(orbit, crossings[index].t);
+
+		/* The prediction may be late by an orbit when the window
+		 * is wider than the drift, let's walk back.
+		 */
+		while ((count - 1) > lower) {
+			offset = _minus_180_to_180(crossings[index].lon -
+						   search->ground->lon);
+			if (fabs(offset + drift) >
+			    (search->lon_tol + _PASS_SEARCH_LON_MARGIN)) {
+				break;
+			}
 
-	if (_tll_crossings_get(orbit, ground->lat, orbit_count, crossings) != 0) {
-		return -1;
-	}
+			_crossings_get(orbit, &search->geometry, count - 1,
+				       previous);
+			if (!_crossing_in_window(&previous[index], search)) {
+				break;
+			}
 
-	while (crossings[0].t <= t) {
-		orbit_count++;
-		if (_tll_crossings_get(orbit, ground->lat, orbit_count,
-				       crossings) != 0) {
-			return -1;
+			count--;
+			memcpy(crossings, previous, sizeof(previous));
 		}
+
+		if (_crossing_in_window(&crossings[index], search)) {
+			*orbit_count = count;
+			return 0;
+		}
+
+		lower = count;
 	}
 
+	return -1;
+}
+
+/*
+ * Searches the next pass starting from the crossings of the given orbit
+ * count. Both are updated to the orbit of the pass found.
+ */
+static int _pass_search(const struct orbit_info *orbit, uint64_t t,
+			const struct ground_search_info *search,
+			int *orbit_count, struct crossing_info crossings[2],
+			struct hubble_pass_info *pass)
+{
+	const struct ground_info *ground = search->ground;
+	struct crossing_info found[2][2];
+	int found_count[2];
+	int index;
+
 	memset(pass, 0, sizeof(*pass));
 
-	if ((fabs(_minus_180_to_180(crossings[0].lon - ground->lon)) <= lon_tol) &&
+	if (_crossing_in_window(&crossings[0], search) &&
 	    (crossings[0].t > t)) {
 		pass->t = crossings[0].t;
 		pass->lon = crossings[0].lon;
 		pass->ascending = ground->lat > 0;
-	} else if ((fabs(_minus_180_to_180(crossings[1].lon - ground->lon)) <=
-		    lon_tol) &&
-		   (crossings[1].t > t)) {
+		return 0;
+	}
+
+	if (_crossing_in_window(&crossings[1], search) &&
+	    (crossings[1].t > t)) {
 		pass->t = crossings[1].t;
 		pass->lon = crossings[1].lon;
 		pass->ascending = ground->lat <= 0;
+		return 0;
 	}
 
-	while (pass->t == 0) {
-		int ret;
+	memcpy(found[0], crossings, sizeof(found[0]));
+	found_count[0] = *orbit_count;
+	if (_window_orbit_get(orbit, 0, search,
+			      *orbit_count + _PASS_SEARCH_ORBITS_MAX,
+			      &found_count[0], found[0]) != 0) {
+		return -1;
+	}
 
-		double delta_lon_a =
-			HUBBLE_TWO_PI_DEGREES -
-			_zero_to_360(ground->lon + lon_tol - crossings[0].lon);
-		double delta_lon_d =
-			HUBBLE_TWO_PI_DEGREES -
-			_zero_to_360(ground->lon + lon_tol - crossings[1].lon);
+	/* The descending crossings are only searched up to the orbit of
+	 * the ascending crossing found.
+	 */
+	index = 0;
+	memcpy(found[1], crossings, sizeof(found[1]));
+	found_count[1] = *orbit_count;
+	if ((_window_orbit_get(orbit, 1, search, found_count[0],
+			       &found_count[1], found[1]) == 0) &&
+	    (found[1][1].t < found[0][0].t)) {
+		index = 1;
+	}
 
-		if (delta_lon_a < delta_lon_d) {
-			ret = _next_pass_get(orbit, true, delta_lon_a, lon_tol,
-					     ground, crossings, pass, t);
-			t = crossings[0].t;
-		} else {
-			ret = _next_pass_get(orbit, false, delta_lon_d, lon_tol,
-					     ground, crossings, pass, t);
-			t = crossings[1].t;
-		}
+	*orbit_count = found_count[index];
+	memcpy(crossings, found[index], sizeof(found[index]));
 
-		if (ret != 0) {
-			return ret;
-		}
+	pass->t = crossings[index].t;
+	pass->lon = crossings[index].lon;
+	pass->ascending = (index == 0) ? ground->lat > 0 : ground->lat <= 0;
+
+	return 0;
+}
+
+/* Gets the orbit count and crossings of the first orbit after t */
+static int _first_crossings_get(const struct orbit_info *orbit, uint64_t t,
+				const struct crossing_geometry *geometry,
+				int *orbit_count,
+				struct crossing_info crossings[2])
+{
+	*orbit_count = _orbit_count_get(orbit, t);
+	if (*orbit_count < 0) {
+		return -1;
+	}
+
+	_crossings_get(orbit, geometry, *orbit_count, crossings);
+
+	while (crossings[0].t <= t) {
+		(*orbit_count)++;
+		_crossings_get(orbit, geometry, *orbit_count, crossings);
 	}
 
 	return 0;
 }
 
+/* Gets the next pass of an orbit. The crossing geometry of the orbit is
+ * set in the search terms.
+ */
+static int _pass_get(const struct orbit_info *orbit, uint64_t t,
+		     struct ground_search_info *search,
+		     struct hubble_pass_info *pass)
+{
+	struct crossing_info crossings[2];
+	int orbit_count;
+
+	if (_crossing_geometry_get(orbit, &search->lat, &search->geometry) !=
+	    0) {
+		return -1;
+	}
+
+	if (_first_crossings_get(orbit, t, &search->geometry, &orbit_count,
+				 crossings) != 0) {
+		return -1;
+	}
+
+	return _pass_search(orbit, t, search, &orbit_count, crossings, pass);
+}
+
+static void _ground_search_info_get(const struct ground_info *ground,
+				    struct ground_search_info *search)
+{
+	search->ground = ground;
+	search->lon_tol = _lon_tolerance_get(ground->lat);
+	_latitude_info_get(ground->lat, &search->lat);
+}
+
 int hubble_next_pass_get(const struct orbit_info *orbit, uint64_t t,
 			 const struct ground_info *ground,
 			 struct hubble_pass_info *pass)
 {
-	double lon_tol;
+	struct ground_search_info search;
 
 	/* Basic sanity check */
 	if ((orbit == NULL) || (ground == NULL) || (pass == NULL)) {
 		return -EINVAL;
 	}
 
-	lon_tol = _lon_tolerance_get(ground->lat);
-	/* TODO: Check a reasonable value for a specific location pass */
+	_ground_search_info_get(ground, &search);
+	/* Point passes do not have a duration, their visibility window is
+	 * given by hubble_next_pass_window_get().
+	 */
 	pass->duration = 0;
 
-	return _pass_get(orbit, t, ground, lon_tol, pass);
+	return _pass_get(orbit, t, &search, pass);
 }
 
-int hubble_next_pass_region_get(const struct orbit_info *orbit, uint64_t t,
-				const struct ground_region_info *region,
-				struct hubble_pass_info *pass)
+/* Gets the visibility window of a point pass. The ground track is taken
+ * as the great circle through the crossing with the heading of the
+ * sub-satellite point relative to the ground. The window is the part of
+ * the track within the footprint angle from the ground.
+ */
+static void _pass_window_get(const struct orbit_info *orbit,
+			     const struct ground_info *ground,
+			     struct hubble_pass_window_info *window)
+{
+	const struct hubble_pass_info *pass = &window->pass;
+	int64_t dt = (int64_t)pass->t - orbit->t0;
+	double rate, ratio, east, north, speed, heading;
+	double dist_sin, dist_cos, bearing, cross, along, edge, half;
+	_real_t lat_sin, lat_cos, dlon_sin, dlon_cos, rel_sin, rel_cos;
+
+	_sincos(_DEG2RAD(ground->lat), &lat_sin, &lat_cos);
+	_sincos(_DEG2RAD(_minus_180_to_180(ground->lon - pass->lon)),
+		&dlon_sin, &dlon_cos);
+
+	/* Velocity, in radians per second, of the sub-satellite point at
+	 * the crossing. The east component of the orbital motion follows
+	 * from the conservation of the angular momentum.
+	 */
+	rate = (2 * M_PI * (orbit->n0 + (orbit->ndot * dt))) + orbit->aopdot;
+	ratio = _cos(_DEG2RAD(orbit->inclination)) / lat_cos;
+	east = (rate * ratio) +
+	       ((orbit->raandot - earth.earth_rotation_rate) * lat_cos);
+	north = rate * _sqrt(HUBBLE_MAX(0.0, 1.0 - (ratio * ratio)));
+	if (!pass->ascending) {
+		north = -north;
+	}
+	speed = _sqrt((east * east) + (north * north));
+	heading = _atan2(east, north);
+
+	/* Distance and bearing from the crossing to the ground */
+	dist_cos = (lat_sin * lat_sin) + (lat_cos * lat_cos * dlon_cos);
+	dist_sin = _sqrt(HUBBLE_MAX(0.0, 1.0 - (dist_cos * dist_cos)));
+	bearing = _atan2(dlon_sin * lat_cos,
+			 lat_sin * lat_cos * (1.0 - dlon_cos));
+
+	/* Cross track and along track distances of the ground, the
+	 * maximum elevation is when the satellite is abeam.
+	 */
+	_sincos(bearing - heading, &rel_sin, &rel_cos);
+	cross = _asin(dist_sin * rel_sin);
+	along = _atan2(dist_sin * rel_cos, dist_cos);
+
+	/* Half of the track within the footprint */
+	edge = _cos(_footprint_angle_get()) / _cos(cross);
+	half = 0.0;
+	if (edge < 1.0) {
+		half = _atan2(_sqrt(1.0 - (edge * edge)), edge) / speed;
+	}
+
+	window->max_elevation_t =
+		(uint64_t)((int64_t)pass->t + _lround(along / speed));
+	window->start = window->max_elevation_t - (uint64_t)_lround(half);
+	window->end = window->max_elevation_t + (uint64_t)_lround(half);
+	window->max_elevation =
+		_RAD2DEG(_atan2(_cos(cross) - (earth.radius /
+					       HUBBLE_SAT_ELEVATION),
+				fabs(_sin(cross))));
+}
+
+int hubble_next_pass_window_get(const struct orbit_info *orbit, uint64_t t,
+				const struct ground_info *ground,
+				struct hubble_pass_window_info *window)
 {
 	int ret;
-	double lon_tol, lat_mid;
-	struct crossing_info crossings_min[2], crossings_max[2];
+
+	/* Basic sanity check */
+	if (window == NULL) {
+		return -EINVAL;
+	}
+
+	ret = hubble_next_pass_get(orbit, t, ground, &window->pass);
+	if (ret == -EINVAL) {
+		return ret;
+	}
+
+	if (ret != 0) {
+		return -ENOENT;
+	}
+
+	_pass_window_get(orbit, ground, window);
+
+	return 0;
+}
+
+int hubble_next_pass_multi_get(const struct orbit_info *orbits, size_t n,
+			       uint64_t t, const struct ground_info *ground,
+			       struct hubble_pass_info *passes,
+			       size_t *indexes, size_t *count)
+{
+	size_t found = 0, i;
+	struct ground_search_info search;
+	struct hubble_pass_info pass;
+
+	/* Basic sanity check */
+	if ((orbits == NULL) || (n == 0U) || (ground == NULL) ||
+	    (passes == NULL) || (count == NULL) || (*count == 0U)) {
+		return -EINVAL;
+	}
+
+	_ground_search_info_get(ground, &search);
+
+	for (size_t orbit_idx = 0; orbit_idx < n; orbit_idx++) {
+		if (_pass_get(&orbits[orbit_idx], t, &search, &pass) != 0) {
+			continue;
+		}
+
+		/* Keep the passes sorted by time, dropping the latest one
+		 * when there is no room left.
+		 */
+		for (i = found; (i > 0) && (passes[i - 1].t > pass.t); i--) {
+			if (i == *count) {
+				continue;
+			}
+
+			passes[i] = passes[i - 1];
+			if (indexes != NULL) {
+				indexes[i] = indexes[i - 1];
+			}
+		}
+
+		if (i == *count) {
+			continue;
+		}
+
+		passes[i] = pass;
+		if (indexes != NULL) {
+			indexes[i] = orbit_idx;
+		}
+
+		if (found < *count) {
+			found++;
+		}
+	}
+
+	*count = found;
+
+	return (found == 0U) ? -ENOENT : 0;
+}
+
+int hubble_pass_iter_init(struct hubble_pass_iter *iter,
+			  const struct orbit_info *orbit, uint64_t t,
+			  const struct ground_info *ground)
+{
+	struct ground_search_info search;
+	struct crossing_info crossings[2];
 	int orbit_count;
-	double lat_min, lat_max;
-	struct ground_info ground;
 
 	/* Basic sanity check */
-	if ((orbit == NULL) || (region == NULL) || (pass == NULL)) {
+	if ((iter == NULL) || (orbit == NULL) || (ground == NULL)) {
+		return -EINVAL;
+	}
+
+	_ground_search_info_get(ground, &search);
+
+	if (_crossing_geometry_get(orbit, &search.lat, &search.geometry) != 0) {
+		return -ENOENT;
+	}
+
+	if (_first_crossings_get(orbit, t, &search.geometry, &orbit_count,
+				 crossings) != 0) {
+		return -ENOENT;
+	}
+
+	*iter = (struct hubble_pass_iter){
+		.orbit = orbit,
+		.ground = *ground,
+		.lon_tol = search.lon_tol,
+		.lat_rad = search.geometry.lat_rad,
+		.ra_asin = search.geometry.ra_asin,
+		.lam_sin = {search.geometry.lam_sin[0],
+			    search.geometry.lam_sin[1]},
+		.lam_cos = {search.geometry.lam_cos[0],
+			    search.geometry.lam_cos[1]},
+		.orbit_count = orbit_count,
+		.started = false,
+		.t = t,
+	};
+
+	for (uint8_t i = 0; i < HUBBLE_ARRAY_SIZE(crossings); i++) {
+		iter->crossing_t[i] = crossings[i].t;
+		iter->crossing_lon[i] = crossings[i].lon;
+	}
+
+	return 0;
+}
+
+int hubble_pass_iter_next(struct hubble_pass_iter *iter,
+			  struct hubble_pass_info *pass)
+{
+	struct ground_search_info search;
+	struct crossing_info crossings[2];
+
+	/* Basic sanity check */
+	if ((iter == NULL) || (iter->orbit == NULL) || (pass == NULL)) {
 		return -EINVAL;
 	}
 
-	lat_mid = region->lat_mid;
-	if (lat_mid == 0.0) {
-		lat_mid = 1e-3;
+	search.ground = &iter->ground;
+	search.lon_tol = iter->lon_tol;
+	search.geometry.lat_rad = iter->lat_rad;
+	search.geometry.ra_asin = iter->ra_asin;
+	memcpy(search.geometry.lam_sin, iter->lam_sin,
+	       sizeof(search.geometry.lam_sin));
+	memcpy(search.geometry.lam_cos, iter->lam_cos,
+	       sizeof(search.geometry.lam_cos));
+
+	for (uint8_t i = 0; i < HUBBLE_ARRAY_SIZE(crossings); i++) {
+		crossings[i].t = iter->crossing_t[i];
+		crossings[i].lon = iter->crossing_lon[i];
+	}
+
+	/* The first call searches from the initial crossings, following
+	 * ones from the orbit after the last pass.
+	 */
+	if (iter->started) {
+		iter->orbit_count++;
+		_crossings_get(iter->orbit, &search.geometry, iter->orbit_count,
+			       crossings);
+	}
+
+	if (_pass_search(iter->orbit, iter->t, &search, &iter->orbit_count,
+			 crossings, pass) != 0) {
+		return -ENOENT;
+	}
+
+	for (uint8_t i = 0; i < HUBBLE_ARRAY_SIZE(crossings); i++) {
+		iter->crossing_t[i] = crossings[i].t;
+		iter->crossing_lon[i] = crossings[i].lon;
+	}
+	iter->started = true;
+	iter->t = pass->t;
+
+	return 0;
+}
+
+/* Crossings of one of the latitude bounds of a region. The last orbit
+ * computed is kept, as the passes of regions sharing the bounds tend to
+ * be on the same orbits.
+ */
+struct region_bound_info {
+	int ret;
+	struct crossing_geometry geometry;
+	int orbit_count;
+	struct crossing_info crossings[2];
+};
+
+/* Terms of a region pass search that only depend on the latitude bounds
+ * of the region, so they are shared by the regions with the same bounds.
+ */
+struct region_band_info {
+	double lat_mid;
+	double lat_min;
+	double lat_max;
+	struct latitude_info lat;
+	struct crossing_geometry geometry;
+	/* First crossings of the middle latitude after t */
+	int orbit_count;
+	struct crossing_info crossings[2];
+	struct region_bound_info min;
+	struct region_bound_info max;
+};
+
+static void _region_bound_info_get(const struct orbit_info *orbit,
+				   double lat, struct region_bound_info *bound)
+{
+	struct latitude_info info;
+
+	_latitude_info_get(lat, &info);
+	bound->ret = _crossing_geometry_get(orbit, &info, &bound->geometry);
+	bound->orbit_count = -1;
+}
+
+static int _region_bound_crossings_get(const struct orbit_info *orbit,
+				       struct region_bound_info *bound,
+				       int orbit_count,
+				       struct crossing_info crossings[2])
+{
+	if (bound->ret != 0) {
+		return -1;
+	}
+
+	if (bound->orbit_count != orbit_count) {
+		_crossings_get(orbit, &bound->geometry, orbit_count,
+			       bound->crossings);
+		bound->orbit_count = orbit_count;
+	}
+
+	memcpy(crossings, bound->crossings, sizeof(bound->crossings));
+
+	return 0;
+}
+
+static int _region_band_info_get(const struct orbit_info *orbit, uint64_t t,
+				 const struct ground_region_info *region,
+				 struct region_band_info *band)
+{
+	band->lat_mid = region->lat_mid;
+	if (band->lat_mid == 0.0) {
+		band->lat_mid = 1e-3;
+	}
+
+	band->lat_min = band->lat_mid - (region->lat_range / 2);
+	band->lat_max = band->lat_mid + (region->lat_range / 2);
+	_region_bound_info_get(orbit, band->lat_min, &band->min);
+	_region_bound_info_get(orbit, band->lat_max, &band->max);
+
+	_latitude_info_get(band->lat_mid, &band->lat);
+	if (_crossing_geometry_get(orbit, &band->lat, &band->geometry) != 0) {
+		return -1;
 	}
 
-	lon_tol = region->lon_range / 2;
-	lat_min = lat_mid - (region->lat_range / 2);
-	lat_max = lat_mid + (region->lat_range / 2);
+	return _first_crossings_get(orbit, t, &band->geometry,
+				    &band->orbit_count, band->crossings);
+}
+
+static int _region_pass_get(const struct orbit_info *orbit, uint64_t t,
+			    const struct ground_region_info *region,
+			    struct region_band_info *band,
+			    struct hubble_pass_info *pass)
+{
+	int ret;
+	struct crossing_info crossings[2];
+	struct crossing_info crossings_min[2], crossings_max[2];
+	int orbit_count;
+	double lat_min = band->lat_min, lat_max = band->lat_max;
+	struct ground_info ground;
+	struct ground_search_info search;
 
-	ground.lat = lat_mid;
+	ground.lat = band->lat_mid;
 	ground.lon = region->lon_mid;
 
-	if (_pass_get(orbit, t, &ground, lon_tol, pass) != 0) {
+	search.ground = &ground;
+	search.lon_tol = region->lon_range / 2;
+	search.lat = band->lat;
+	search.geometry = band->geometry;
+
+	orbit_count = band->orbit_count;
+	memcpy(crossings, band->crossings, sizeof(crossings));
+	if (_pass_search(orbit, t, &search, &orbit_count, crossings, pass) !=
+	    0) {
 		return -1;
 	}
 
@@ -625,28 +1543,29 @@ int hubble_next_pass_region_get(const struct orbit_info *orbit, uint64_t t,
 	}
 
 	if ((lat_min * lat_max) < 0) {
-		ret = _tll_crossings_get(orbit, lat_min, orbit_count,
-					 crossings_min);
+		ret = _region_bound_crossings_get(orbit, &band->min,
+						  orbit_count, crossings_min);
 		if (pass->ascending) {
-			ret |= _tll_crossings_get(
-				orbit, lat_max, orbit_count + 1, crossings_max);
+			ret |= _region_bound_crossings_get(
+				orbit, &band->max, orbit_count + 1,
+				crossings_max);
 			if (ret != 0) {
 				return -1;
 			}
 			pass->duration = crossings_max[0].t - crossings_min[1].t;
 		} else {
-			ret |= _tll_crossings_get(orbit, lat_max, orbit_count,
-						  crossings_max);
+			ret |= _region_bound_crossings_get(
+				orbit, &band->max, orbit_count, crossings_max);
 			if (ret != 0) {
 				return -1;
 			}
 			pass->duration = crossings_min[0].t - crossings_max[1].t;
 		}
 	} else if ((lat_min < 0) && (lat_max < 0)) {
-		ret = _tll_crossings_get(orbit, lat_min, orbit_count,
-					 crossings_min);
-		ret |= _tll_crossings_get(orbit, lat_max, orbit_count,
-					  crossings_max);
+		ret = _region_bound_crossings_get(orbit, &band->min,
+						  orbit_count, crossings_min);
+		ret |= _region_bound_crossings_get(orbit, &band->max,
+						   orbit_count, crossings_max);
 
 		if (ret != 0) {
 			return -1;
@@ -662,10 +1581,10 @@ int hubble_next_pass_region_get(const struct orbit_info *orbit, uint64_t t,
 			return -1;
 		}
 
-		ret = _tll_crossings_get(orbit, lat_min, orbit_count,
-					 crossings_min);
-		ret |= _tll_crossings_get(orbit, lat_max, orbit_count,
-					  crossings_max);
+		ret = _region_bound_crossings_get(orbit, &band->min,
+						  orbit_count, crossings_min);
+		ret |= _region_bound_crossings_get(orbit, &band->max,
+						   orbit_count, crossings_max);
 
 		if (ret != 0) {
 			return -1;
@@ -682,3 +1601,115 @@ int hubble_next_pass_region_get(const struct orbit_info *orbit, uint64_t t,
 
 	return 0;
 }
+
+int hubble_next_pass_region_get(const struct orbit_info *orbit, uint64_t t,
+				const struct ground_region_info *region,
+				struct hubble_pass_info *pass)
+{
+	struct region_band_info band;
+
+	/* Basic sanity check */
+	if ((orbit == NULL) || (region == NULL) || (pass == NULL)) {
+		return -EINVAL;
+	}
+
+	if (_region_band_info_get(orbit, t, region, &band) != 0) {
+		return -1;
+	}
+
+	return _region_pass_get(orbit, t, region, &band, pass);
+}
+
+static bool _region_band_equal(const struct ground_region_info *a,
+			       const struct ground_region_info *b)
+{
+	return (a->lat_mid == b->lat_mid) && (a->lat_range == b->lat_range);
+}
+
+int hubble_next_pass_regions_get(const struct orbit_info *orbit, uint64_t t,
+				 const struct ground_region_info *regions,
+				 size_t n, struct hubble_pass_info *passes,
+				 int *status, size_t *found)
+{
+	int ret;
+	size_t i, j, count = 0;
+	struct region_band_info band;
+
+	/* Basic sanity check */
+	if ((orbit == NULL) || (regions == NULL) || (passes == NULL) ||
+	    (n == 0U)) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n; i++) {
+		/* Regions are searched together with the first one with the
+		 * same latitude bounds.
+		 */
+		for (j = 0; j < i; j++) {
+			if (_region_band_equal(&regions[j], &regions[i])) {
+				break;
+			}
+		}
+
+		if (j < i) {
+			continue;
+		}
+
+		ret = _region_band_info_get(orbit, t, &regions[i], &band);
+
+		for (j = i; j < n; j++) {
+			if (!_region_band_equal(&regions[i], &regions[j])) {
+				continue;
+			}
+
+			if ((ret != 0) || (_region_pass_get(orbit, t, &regions[j],
+							     &band,
+							     &passes[j]) != 0)) {
+				memset(&passes[j], 0, sizeof(passes[j]));
+				if (status != NULL) {
+					status[j] = -ENOENT;
+				}
+				continue;
+			}
+
+			if (status != NULL) {
+				status[j] = 0;
+			}
+			count++;
+		}
+	}
+
+	if (found != NULL) {
+		*found = count;
+	}
+
+	return (count > 0U) ? 0 : -ENOENT;
+}
+
+double hubble_internal_pass_loss_db_get(const struct orbit_info *orbit,
+					const struct ground_info *ground,
+					const struct hubble_pass_info *pass,
+					int64_t offset_s)
+{
+	double cross, along, gamma_cos, range;
+
+	/* Cross track offset at the pass latitude and along track offset
+	 * from the pass centre, the satellite moves one orbit per 1 / n0.
+	 */
+	cross = _DEG2RAD(_minus_180_to_180(pass->lon - ground->lon)) *
+		_cos(_DEG2RAD(ground->lat));
+	along = 2 * M_PI * orbit->n0 * (double)offset_s;
+
+	/* Central angle between the ground and the sub-satellite point */
+	gamma_cos = _cos(cross) * _cos(along);
+	if (gamma_cos <= (earth.radius / HUBBLE_SAT_ELEVATION)) {
+		/* Below the horizon */
+		return INFINITY;
+	}
+
+	range = _sqrt((earth.radius * earth.radius) +
+		      (HUBBLE_SAT_ELEVATION * HUBBLE_SAT_ELEVATION) -
+		      (2 * earth.radius * HUBBLE_SAT_ELEVATION * gamma_cos));
+
+	return 20.0 * log10(range / (HUBBLE_SAT_ELEVATION - earth.radius));
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <hubble/sat/orbit_bundle.h>
+
+#include "utils/crc32.h"
+
+/* Records are used in place, so the bundle, and the record size, are
+ * aligned to their largest fields.
+ */
+#define HUBBLE_ORBIT_BUNDLE_ALIGN 8U
+
+/* The comparisons are written so NaNs are rejected */
+static bool _record_is_valid(const struct hubble_orbit_record *record)
+{
+	const struct orbit_info *orbit = &record->orbit;
+
+	if (!(orbit->n0 > 0.0)) {
+		return false;
+	}
+
+	if (!((orbit->eccentricity >= 0.0) && (orbit->eccentricity < 1.0))) {
+		return false;
+	}
+
+	if (!((orbit->inclination >= 0.0) && (orbit->inclination <= 180.0))) {
+		return false;
+	}
+
+	if ((orbit->ndot != orbit->ndot) || (orbit->raan0 != orbit->raan0) ||
+	    (orbit->raandot != orbit->raandot) ||
+	    (orbit->aop0 != orbit->aop0) || (orbit->aopdot != orbit->aopdot)) {
+		return false;
+	}
+
+	return record->valid_start <= record->valid_end;
+}
+
+int hubble_orbit_bundle_open(struct hubble_orbit_bundle *bundle,
+			     const void *data, size_t len)
+{
+	const struct hubble_orbit_bundle_header *header = data;
+	const uint8_t *records;
+	size_t records_len;
+
+	/* Basic sanity check */
+	if ((bundle == NULL) || (data == NULL) ||
+	    (((uintptr_t)data % HUBBLE_ORBIT_BUNDLE_ALIGN) != 0U)) {
+		return -EINVAL;
+	}
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+	return -ENOTSUP;
+#endif
+
+	if ((len < sizeof(*header)) ||
+	    (header->magic != HUBBLE_ORBIT_BUNDLE_MAGIC)) {
+		return -EBADMSG;
+	}
+
+	if (header->version != HUBBLE_ORBIT_BUNDLE_VERSION) {
+		return -ENOTSUP;
+	}
+
+	if ((header->record_size < sizeof(struct hubble_orbit_record)) ||
+	    ((header->record_size % HUBBLE_ORBIT_BUNDLE_ALIGN) != 0U)) {
+		return -EBADMSG;
+	}
+
+	records = (const uint8_t *)data + sizeof(*header);
+	records_len = (size_t)header->count * header->record_size;
+	if ((len - sizeof(*header)) < records_len) {
+		return -EBADMSG;
+	}
+
+	if (hubble_crc32(records, records_len) != header->crc) {
+		return -EBADMSG;
+	}
+
+	for (size_t i = 0; i < header->count; i++) {
+		if (!_record_is_valid(
+			    (const struct hubble_orbit_record
+				     *)(records + (i * header->record_size)))) {
+			return -EBADMSG;
+		}
+	}
+
+	bundle->records = records;
+	bundle->count = header->count;
+	bundle->record_size = header->record_size;
+
+	return 0;
+}
+
+size_t hubble_orbit_bundle_count(const struct hubble_orbit_bundle *bundle)
+{
+	if (bundle == NULL) {
+		return 0;
+	}
+
+	return bundle->count;
+}
+
+const struct hubble_orbit_record *
+hubble_orbit_bundle_record_get(const struct hubble_orbit_bundle *bundle,
+			       size_t index)
+{
+	if ((bundle == NULL) || (index >= bundle->count)) {
+		return NULL;
+	}
+
+	return (const struct hubble_orbit_record *)(bundle->records +
+						    (index *
+						     bundle->record_size));
+}
+
+const struct orbit_info *
+hubble_orbit_bundle_find(const struct hubble_orbit_bundle *bundle,
+			 uint32_t id, uint64_t t)
+{
+	const struct hubble_orbit_record *record, *found = NULL;
+
+	for (size_t i = 0; i < hubble_orbit_bundle_count(bundle); i++) {
+		record = hubble_orbit_bundle_record_get(bundle, i);
+		if ((record->id != id) || (t < record->valid_start) ||
+		    (t > record->valid_end)) {
+			continue;
+		}
+
+		if ((found == NULL) || (record->orbit.t0 > found->orbit.t0)) {
+			found = record;
+		}
+	}
+
+	return (found == NULL) ? NULL : &found->orbit;
+}
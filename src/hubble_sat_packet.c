@@ -5,12 +5,14 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include <hubble/sat/packet.h>
 #include <hubble/port/sat_radio.h>
 #include <hubble/port/sys.h>
 
+#include "hubble_priv.h"
 #include "reed_solomon_encoder.h"
 #include "utils/bitarray.h"
 #include "utils/macros.h"
@@ -27,9 +29,6 @@
 #define HUBBLE_PHY_ECC_SYMBOLS_SIZE          4U
 #define HUBBLE_PHY_SYMBOLS_SIZE              2U
 
-/* Number of bits to represent a symbol */
-#define HUBBLE_SYMBOL_SIZE                   6U
-
 #define HUBBLE_PAYLOAD_PROTOCOL_VERSION      0U
 #define HUBBLE_PAYLOAD_PROTOCOL_VERSION_SIZE 2U
 /* Number of bits to represent a device id */
@@ -40,11 +39,18 @@
 
 #define HUBBLE_PAYLOAD_MAX_SIZE              13U
 
-#define HUBBLE_SAT_CHANNEL_DEFAULT           5U
+/* Number of bits before the authentication tag (version, sequence number
+ * and device id) and the symbol where the authentication tag starts. The
+ * tag and the payload change on every packet.
+ */
+#define HUBBLE_AUTH_TAG_OFFSET                                                 \
+	(HUBBLE_PAYLOAD_PROTOCOL_VERSION_SIZE + HUBBLE_SEQUENCE_NUMBER_SIZE +  \
+	 HUBBLE_DEVICE_ID_SIZE)
+#define HUBBLE_AUTH_TAG_SYMBOL (HUBBLE_AUTH_TAG_OFFSET / HUBBLE_SYMBOL_SIZE)
 
-static uint16_t _sequence_number;
+#define HUBBLE_SAT_CHANNEL_DEFAULT           5U
 
-static int _encode(const struct hubble_bitarray *bit_array, int *symbols,
+static int _encode(const struct hubble_bitarray *bit_array, uint8_t *symbols,
 		   size_t symbols_size)
 {
 	uint8_t symbol = 0U;
@@ -76,59 +82,117 @@ static int _encode(const struct hubble_bitarray *bit_array, int *symbols,
 	return index;
 }
 
-static int _packet_payload_ecc_get(size_t len)
+/* Generator polynomials (index form) of the codes used by the protocol.
+ * They are the output of rse_poly_generate() for the given number of
+ * parity symbols.
+ */
+static const int8_t _rs_generator_4[] = {10, 24, 41, 19, 0};
+
+/* PHY header parity */
+RSE_RS_ENCODER_DEFINE(_phy_parity_get, HUBBLE_PHY_SYMBOLS_SIZE,
+		      HUBBLE_PHY_ECC_SYMBOLS_SIZE, _rs_generator_4)
+
+/* Every payload size class has its own encoder, with a fixed number of
+ * data and parity symbols. Applications can build a subset of them.
+ */
+#if !defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM) ||                \
+	defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_0)
+static const int8_t _rs_generator_10[] = {55, 37, 61, 6,  1, 60,
+					  53, 47, 28, 56, 0};
+RSE_RS_ENCODER_DEFINE(_parity_get_0, 13, 10, _rs_generator_10)
+#define _SIZE_CLASS_0 {0, 13, 10, 0b00, _parity_get_0},
+#else
+#define _SIZE_CLASS_0
+#endif
+
+#if !defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM) ||                \
+	defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_4)
+static const int8_t _rs_generator_12[] = {15, 62, 1,  20, 32, 10, 28,
+					  60, 6,  44, 12, 60, 0};
+RSE_RS_ENCODER_DEFINE(_parity_get_4, 18, 12, _rs_generator_12)
+#define _SIZE_CLASS_4 {4, 18, 12, 0b01, _parity_get_4},
+#else
+#define _SIZE_CLASS_4
+#endif
+
+#if !defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM) ||                \
+	defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_9)
+static const int8_t _rs_generator_14[] = {42, 11, 21, 42, 32, 21, 56, 7,
+					  41, 54, 50, 45, 9,  47, 0};
+RSE_RS_ENCODER_DEFINE(_parity_get_9, 25, 14, _rs_generator_14)
+#define _SIZE_CLASS_9 {9, 25, 14, 0b10, _parity_get_9},
+#else
+#define _SIZE_CLASS_9
+#endif
+
+#if !defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM) ||                \
+	defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_13)
+static const int8_t _rs_generator_16[] = {10, 21, 17, 23, 21, 12, 25, 50, 38,
+					  33, 54, 24, 16, 1,  41, 28, 0};
+RSE_RS_ENCODER_DEFINE(_parity_get_13, 30, 16, _rs_generator_16)
+#define _SIZE_CLASS_13 {13, 30, 16, 0b11, _parity_get_13},
+#else
+#define _SIZE_CLASS_13
+#endif
+
+#if defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZES_CUSTOM) &&                 \
+	!defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_0) &&                  \
+	!defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_4) &&                  \
+	!defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_9) &&                  \
+	!defined(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_13)
+#error "At least one satellite payload size must be enabled"
+#endif
+
+struct _size_class {
+	/* Payload length in bytes */
+	uint8_t length;
+	/* Number of data and parity symbols */
+	uint8_t symbols_length;
+	uint8_t ecc;
+	/* Payload length as encoded in the physical header */
+	uint8_t length_symbol;
+	void (*parity_get)(const uint8_t *symbols, uint8_t *parity);
+};
+
+/* Sorted by payload length */
+static const struct _size_class _size_classes[] = {
+	_SIZE_CLASS_0 _SIZE_CLASS_4 _SIZE_CLASS_9 _SIZE_CLASS_13};
+
+#undef _SIZE_CLASS_0
+#undef _SIZE_CLASS_4
+#undef _SIZE_CLASS_9
+#undef _SIZE_CLASS_13
+
+/* Smallest size class that fits the given payload length */
+static const struct _size_class *_size_class_fit_get(size_t length)
 {
-	int ecc;
-
-	switch (len) {
-	case 0:
-		ecc = 10;
-		break;
-	case 4:
-		ecc = 12;
-		break;
-	case 9:
-		ecc = 14;
-		break;
-	case 13:
-		ecc = 16;
-		break;
-	default:
-		ecc = -1;
-		break;
-	}
-
-	return ecc;
+	for (uint8_t i = 0; i < HUBBLE_ARRAY_SIZE(_size_classes); i++) {
+		if (length <= _size_classes[i].length) {
+			return &_size_classes[i];
+		}
+	}
+
+	return NULL;
 }
 
-static int8_t _packet_payload_size_get(size_t len, uint8_t *length,
-				       uint8_t *symbol)
+/* Largest enabled payload size */
+static size_t _size_class_max_get(void)
 {
-	switch (len) {
-	case 0:
-		*length = 13;
-		*symbol = 0b00;
-		break;
-	case 4:
-		*length = 18;
-		*symbol = 0b01;
-		break;
-	case 9:
-		*length = 25;
-		*symbol = 0b10;
-		break;
-	case 13:
-		*length = 30;
-		*symbol = 0b11;
-		break;
-	default:
-		return -EINVAL;
+	return _size_classes[HUBBLE_ARRAY_SIZE(_size_classes) - 1].length;
+}
+
+static const struct _size_class *_size_class_get(size_t length)
+{
+	const struct _size_class *size_class = _size_class_fit_get(length);
+
+	if ((size_class == NULL) || (size_class->length != length)) {
+		return NULL;
 	}
 
-	return 0;
+	return size_class;
 }
 
-static int _whitening(uint8_t seed, int *symbols, size_t len)
+static int _whitening(uint8_t seed, uint8_t *symbols, size_t len)
 {
 	uint8_t state;
 	size_t symbols_idx = 0U;
@@ -156,15 +220,55 @@ static int _whitening(uint8_t seed, int *symbols, size_t len)
 	return 0;
 }
 
-int hubble_sat_packet_get(struct hubble_sat_packet *packet, uint64_t device_id,
-			  const void *payload, size_t length)
+#define _CHECK_RET(_ret)                                                       \
+	if (_ret < 0) {                                                        \
+		return _ret;                                                   \
+	}
+
+/* Encodes the PHY header for the channel and hopping sequence set in the
+ * packet.
+ */
+static int _phy_header_build(struct hubble_sat_packet *packet,
+			     uint8_t payload_length_symbol)
 {
 	int ret;
 	struct hubble_bitarray bit_array;
-	uint8_t ecc;
-	int symbols[HUBBLE_PACKET_MAX_SIZE] = {0};
-	int *rs_symbols;
-	uint8_t payload_symbols_length, payload_length_symbol, channel;
+
+	hubble_bitarray_init(&bit_array);
+
+	ret = hubble_bitarray_append(
+		&bit_array, (uint8_t *)&(uint8_t){HUBBLE_PHY_PROTOCOL_VERSION},
+		HUBBLE_PHY_PROTOCOL_SIZE);
+	_CHECK_RET(ret);
+
+	ret = hubble_bitarray_append(&bit_array, &payload_length_symbol,
+				     HUBBLE_PHY_PAYLOAD_SIZE);
+	_CHECK_RET(ret);
+
+	ret = hubble_bitarray_append(
+		&bit_array, (uint8_t *)&(uint8_t){packet->hopping_sequence},
+		HUBBLE_PHY_HOP_INFO_SIZE);
+	_CHECK_RET(ret);
+
+	ret = hubble_bitarray_append(&bit_array,
+				     (uint8_t *)&(uint8_t){packet->channel},
+				     HUBBLE_PHY_CHANNEL_SIZE);
+	_CHECK_RET(ret);
+
+	ret = _encode(&bit_array, packet->data, HUBBLE_PHY_SYMBOLS_SIZE);
+	_CHECK_RET(ret);
+	packet->length = HUBBLE_PHY_SYMBOLS_SIZE;
+
+	_phy_parity_get(packet->data, &packet->data[packet->length]);
+	packet->length += HUBBLE_PHY_ECC_SYMBOLS_SIZE;
+
+	return 0;
+}
+
+static int _phy_header_encode(struct hubble_sat_packet *packet,
+			      uint8_t payload_length_symbol)
+{
+	uint8_t channel;
 
 	if (hubble_rand_get(&channel, sizeof(channel))) {
 		packet->channel = HUBBLE_SAT_CHANNEL_DEFAULT;
@@ -175,115 +279,617 @@ int hubble_sat_packet_get(struct hubble_sat_packet *packet, uint64_t device_id,
 
 	packet->hopping_sequence = channel % (1U << HUBBLE_PHY_HOP_INFO_SIZE);
 
-	if (_packet_payload_size_get(length, &payload_symbols_length,
-				     &payload_length_symbol) < 0) {
+	return _phy_header_build(packet, payload_length_symbol);
+}
+
+/* Parity of a frame that only has a unit symbol at the given position. */
+static void _unit_parity_get(const struct _size_class *size_class,
+			     uint8_t position, uint8_t *parity)
+{
+	uint8_t symbols[HUBBLE_SAT_PACKET_FRAME_SYMBOLS_MAX] = {0};
+
+	symbols[position] = 1;
+	size_class->parity_get(symbols, parity);
+}
+
+int hubble_sat_packet_template_init(struct hubble_sat_packet_template *tmpl,
+				    uint64_t device_id, size_t length)
+{
+	int ret;
+	struct hubble_bitarray bit_array;
+	const struct _size_class *size_class = _size_class_get(length);
+
+	if ((tmpl == NULL) || (size_class == NULL)) {
 		return -EINVAL;
 	}
 
-	/* Let's encode physical frame (without preamble) */
+	tmpl->symbols_length = size_class->symbols_length;
+	tmpl->length_symbol = size_class->length_symbol;
+	tmpl->ecc = size_class->ecc;
+	tmpl->length = length;
+	tmpl->dev_id = device_id;
+
 	hubble_bitarray_init(&bit_array);
 
-#define _CHECK_RET(_ret)                                                       \
-	if (_ret < 0) {                                                        \
-		return _ret;                                                   \
+	/* Payload version */
+	ret = hubble_bitarray_append(
+		&bit_array,
+		(uint8_t *)&(uint8_t){HUBBLE_PAYLOAD_PROTOCOL_VERSION},
+		HUBBLE_PAYLOAD_PROTOCOL_VERSION_SIZE);
+	_CHECK_RET(ret);
+
+	/* Sequence number is variable, it is added when building a packet */
+	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&(uint16_t){0},
+				     HUBBLE_SEQUENCE_NUMBER_SIZE);
+	_CHECK_RET(ret);
+
+	/* Device ID */
+	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&device_id,
+				     HUBBLE_DEVICE_ID_SIZE);
+	_CHECK_RET(ret);
+
+	/* Symbols after the device id only carry the authentication tag and
+	 * the payload, they stay zero.
+	 */
+	memset(tmpl->symbols, 0, sizeof(tmpl->symbols));
+	ret = _encode(&bit_array, tmpl->symbols,
+		      HUBBLE_SAT_PACKET_FRAME_SYMBOLS_MAX);
+	_CHECK_RET(ret);
+
+	size_class->parity_get(tmpl->symbols, tmpl->parity);
+
+	for (uint8_t i = 0; i < HUBBLE_ARRAY_SIZE(tmpl->sequence_parity); i++) {
+		_unit_parity_get(size_class, i, tmpl->sequence_parity[i]);
 	}
 
-	ret = hubble_bitarray_append(
-		&bit_array, (uint8_t *)&(uint8_t){HUBBLE_PHY_PROTOCOL_VERSION},
-		HUBBLE_PHY_PROTOCOL_SIZE);
+	return 0;
+}
+
+static int _packet_from_template_encode(
+	struct hubble_sat_packet *packet,
+	const struct hubble_sat_packet_template *tmpl, const void *payload,
+	uint16_t sequence_number)
+{
+	int ret;
+	struct hubble_bitarray bit_array;
+	uint8_t *symbols;
+	uint8_t sequence_symbols[2];
+	uint8_t auth_tag[HUBBLE_AUTH_TAG_SIZE / HUBBLE_CHAR_BITS];
+	uint8_t ecc;
+	const struct _size_class *size_class = _size_class_get(tmpl->length);
+
+	if (size_class == NULL) {
+		return -EINVAL;
+	}
+
+	ret = _phy_header_encode(packet, tmpl->length_symbol);
 	_CHECK_RET(ret);
 
-	ret = hubble_bitarray_append(&bit_array, &payload_length_symbol,
-				     HUBBLE_PHY_PAYLOAD_SIZE);
+	/* The frame is encoded in place, right after the PHY header */
+	symbols = &packet->data[packet->length];
+	memset(symbols, 0, HUBBLE_PACKET_MAX_SIZE - packet->length);
+
+	sequence_number &= (1U << HUBBLE_SEQUENCE_NUMBER_SIZE) - 1U;
+
+	ret = hubble_internal_sat_auth_tag_get(sequence_number, tmpl->dev_id,
+					       payload, tmpl->length, auth_tag,
+					       sizeof(auth_tag));
 	_CHECK_RET(ret);
 
-	ret = hubble_bitarray_append(
-		&bit_array, (uint8_t *)&(uint8_t){packet->hopping_sequence},
-		HUBBLE_PHY_HOP_INFO_SIZE);
+	/* Authentication tag and payload symbols. The tag does not start at
+	 * a symbol boundary, so the bits preceding it in the first symbol are
+	 * left as zero.
+	 */
+	hubble_bitarray_init(&bit_array);
+
+	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&(uint8_t){0},
+				     HUBBLE_AUTH_TAG_OFFSET %
+					     HUBBLE_SYMBOL_SIZE);
 	_CHECK_RET(ret);
 
-	ret = hubble_bitarray_append(&bit_array,
-				     (uint8_t *)&(uint8_t){packet->channel},
-				     HUBBLE_PHY_CHANNEL_SIZE);
+	ret = hubble_bitarray_append(&bit_array, auth_tag, HUBBLE_AUTH_TAG_SIZE);
 	_CHECK_RET(ret);
 
-	ret = _encode(&bit_array, symbols, HUBBLE_PHY_SYMBOLS_SIZE);
+	ret = hubble_bitarray_append(&bit_array, (uint8_t *)payload,
+				     tmpl->length * HUBBLE_CHAR_BITS);
+	_CHECK_RET(ret);
+
+	ret = _encode(&bit_array, &symbols[HUBBLE_AUTH_TAG_SYMBOL],
+		      HUBBLE_PACKET_MAX_SIZE - packet->length -
+			      HUBBLE_AUTH_TAG_SYMBOL);
 	_CHECK_RET(ret);
 
-	for (uint8_t i = 0; i < HUBBLE_PHY_SYMBOLS_SIZE; i++) {
-		packet->data[i] = symbols[i];
+	/* Parity of a frame holding only the tag and the payload, written
+	 * right after the data symbols.
+	 */
+	ecc = tmpl->ecc;
+	size_class->parity_get(symbols, &symbols[tmpl->symbols_length]);
+
+	/* Sequence number spans the first two symbols, right after the
+	 * payload version.
+	 */
+	sequence_symbols[0] = (sequence_number >> HUBBLE_SYMBOL_SIZE) &
+			      ((1U << (HUBBLE_SYMBOL_SIZE -
+				       HUBBLE_PAYLOAD_PROTOCOL_VERSION_SIZE)) -
+			       1U);
+	sequence_symbols[1] = sequence_number & ((1U << HUBBLE_SYMBOL_SIZE) - 1U);
+
+	/* Combine both parts. Parity is linear, so the parity of the frame
+	 * is the sum (XOR) of the parity of each part.
+	 */
+	for (uint8_t i = 0; i < ecc; i++) {
+		symbols[tmpl->symbols_length + i] ^=
+			tmpl->parity[i] ^
+			rse_gf_mul(sequence_symbols[0],
+				   tmpl->sequence_parity[0][i]) ^
+			rse_gf_mul(sequence_symbols[1],
+				   tmpl->sequence_parity[1][i]);
 	}
-	packet->length = HUBBLE_PHY_SYMBOLS_SIZE;
 
-	rse_gf_generate();
-	rse_poly_generate(HUBBLE_PHY_ECC_SYMBOLS_SIZE / 2);
-	rs_symbols = rse_rs_encode(symbols, HUBBLE_PHY_SYMBOLS_SIZE,
-				   HUBBLE_PHY_ECC_SYMBOLS_SIZE / 2);
+	for (uint8_t i = 0; i < tmpl->symbols_length; i++) {
+		symbols[i] |= tmpl->symbols[i];
+	}
+	symbols[0] |= sequence_symbols[0];
+	symbols[1] |= sequence_symbols[1];
 
-	for (uint8_t i = 0; i < HUBBLE_PHY_ECC_SYMBOLS_SIZE; i++) {
-		packet->data[i + packet->length] = rs_symbols[i];
+	/* data whitening symbols before add them to the packet */
+	ret = _whitening(packet->channel, symbols, tmpl->symbols_length + ecc);
+	_CHECK_RET(ret);
+
+	packet->length += tmpl->symbols_length + ecc;
+
+	return 0;
+}
+
+int hubble_sat_packet_from_template_get(
+	struct hubble_sat_packet *packet,
+	const struct hubble_sat_packet_template *tmpl, const void *payload)
+{
+	int ret;
+	uint16_t sequence_number;
+
+	if ((packet == NULL) || (tmpl == NULL) ||
+	    ((payload == NULL) && (tmpl->length > 0U))) {
+		return -EINVAL;
 	}
-	packet->length += HUBBLE_PHY_ECC_SYMBOLS_SIZE;
 
-	/* End of physical frame */
+	ret = hubble_internal_sat_sequence_get(1U, &sequence_number);
+	_CHECK_RET(ret);
+
+	return _packet_from_template_encode(packet, tmpl, payload,
+					    sequence_number);
+}
+
+int hubble_sat_packet_channel_variant_get(
+	const struct hubble_sat_packet *packet, uint8_t channel,
+	struct hubble_sat_packet *variant)
+{
+	int ret;
+	uint8_t payload_length_symbol, old_channel;
+	size_t length, frame_length;
+	static const uint8_t packet_lengths[] = {29, 36, 45, 52};
+
+	if ((packet == NULL) || (variant == NULL) ||
+	    (channel >= HUBBLE_SAT_NUM_CHANNELS)) {
+		return -EINVAL;
+	}
+
+	/* The packet length tells the payload size class */
+	for (payload_length_symbol = 0;
+	     payload_length_symbol < HUBBLE_ARRAY_SIZE(packet_lengths);
+	     payload_length_symbol++) {
+		if (packet_lengths[payload_length_symbol] == packet->length) {
+			break;
+		}
+	}
+
+	if (payload_length_symbol == HUBBLE_ARRAY_SIZE(packet_lengths)) {
+		return -EINVAL;
+	}
+
+	/* Packet and variant can be the same */
+	old_channel = packet->channel;
+	length = packet->length;
+
+	if (variant != packet) {
+		*variant = *packet;
+	}
+	variant->channel = channel;
+
+	ret = _phy_header_build(variant, payload_length_symbol);
+	_CHECK_RET(ret);
+
+	/* Whitening is a XOR with a sequence seeded by the channel. Undo the
+	 * original one and apply the new one, there is no need to encode the
+	 * packet again.
+	 */
+	frame_length = length - variant->length;
+
+	ret = _whitening(old_channel, &variant->data[variant->length],
+			 frame_length);
+	_CHECK_RET(ret);
+
+	ret = _whitening(channel, &variant->data[variant->length],
+			 frame_length);
+	_CHECK_RET(ret);
+
+	variant->length += frame_length;
+
+	return 0;
+}
+
+/* Encodes the whole frame at once. Templates precompute the parity of
+ * the fixed fields, which costs more than a single packet.
+ */
+static int _packet_encode(struct hubble_sat_packet *packet,
+			  const struct _size_class *size_class,
+			  uint64_t device_id, const void *payload,
+			  uint16_t sequence_number)
+{
+	int ret;
+	struct hubble_bitarray bit_array;
+	uint8_t *symbols;
+	uint8_t auth_tag[HUBBLE_AUTH_TAG_SIZE / HUBBLE_CHAR_BITS];
+	size_t length = size_class->length;
+
+	ret = _phy_header_encode(packet, size_class->length_symbol);
+	_CHECK_RET(ret);
+
+	symbols = &packet->data[packet->length];
+	memset(symbols, 0, HUBBLE_PACKET_MAX_SIZE - packet->length);
+
+	sequence_number &= (1U << HUBBLE_SEQUENCE_NUMBER_SIZE) - 1U;
+
+	ret = hubble_internal_sat_auth_tag_get(sequence_number, device_id,
+					       payload, length, auth_tag,
+					       sizeof(auth_tag));
+	_CHECK_RET(ret);
 
-	/* Packet payload now. */
 	hubble_bitarray_init(&bit_array);
 
-	/* Payload version */
 	ret = hubble_bitarray_append(
 		&bit_array,
 		(uint8_t *)&(uint8_t){HUBBLE_PAYLOAD_PROTOCOL_VERSION},
 		HUBBLE_PAYLOAD_PROTOCOL_VERSION_SIZE);
 	_CHECK_RET(ret);
 
-	/* Sequence number */
-	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&_sequence_number,
+	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&sequence_number,
 				     HUBBLE_SEQUENCE_NUMBER_SIZE);
 	_CHECK_RET(ret);
 
-	_sequence_number++;
-
-	/* Device ID */
 	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&device_id,
 				     HUBBLE_DEVICE_ID_SIZE);
 	_CHECK_RET(ret);
 
-	/* Authentication tag */
-	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&(uint32_t){0},
+	ret = hubble_bitarray_append(&bit_array, auth_tag,
 				     HUBBLE_AUTH_TAG_SIZE);
 	_CHECK_RET(ret);
 
-	/* Payload */
 	ret = hubble_bitarray_append(&bit_array, (uint8_t *)payload,
 				     length * HUBBLE_CHAR_BITS);
 	_CHECK_RET(ret);
 
-	/* This returns the number of symbols */
-	ret = _encode(&bit_array, symbols, HUBBLE_PACKET_MAX_SIZE);
+	ret = _encode(&bit_array, symbols,
+		      HUBBLE_PACKET_MAX_SIZE - packet->length);
 	_CHECK_RET(ret);
 
-	/* generate error control symbols */
-	rse_gf_generate();
-	ecc = _packet_payload_ecc_get(length);
-	rse_poly_generate(ecc / 2);
-	rs_symbols = rse_rs_encode(symbols, ret, ecc / 2);
+	size_class->parity_get(symbols, &symbols[size_class->symbols_length]);
 
-	/* We need to append rs_symbols to symbols before whitening them
-	 * due lfsr7 state.
+	ret = _whitening(packet->channel, symbols,
+			 size_class->symbols_length + size_class->ecc);
+	_CHECK_RET(ret);
+
+	packet->length += size_class->symbols_length + size_class->ecc;
+
+	return 0;
+}
+
+int hubble_sat_packet_get(struct hubble_sat_packet *packet, uint64_t device_id,
+			  const void *payload, size_t length)
+{
+	int ret;
+	uint16_t sequence_number;
+	const struct _size_class *size_class = _size_class_get(length);
+
+	if ((packet == NULL) || (size_class == NULL) ||
+	    ((payload == NULL) && (length > 0U))) {
+		return -EINVAL;
+	}
+
+	ret = hubble_internal_sat_sequence_get(1U, &sequence_number);
+	_CHECK_RET(ret);
+
+	return _packet_encode(packet, size_class, device_id, payload,
+			      sequence_number);
+}
+
+/* Fragment header: index (4 bits) | last flag (1 bit) | padding (3 bits) */
+#define _FRAGMENT_INDEX_SHIFT 4U
+#define _FRAGMENT_LAST        (1U << 3)
+#define _FRAGMENT_PADDING_MAX 0x7U
+
+int hubble_sat_packet_fragments_count(size_t length)
+{
+	if (length > HUBBLE_SAT_MESSAGE_MAX) {
+		return -EINVAL;
+	}
+
+	if (length == 0U) {
+		return 1;
+	}
+
+	return (length + HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX - 1) /
+	       HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX;
+}
+
+int hubble_sat_packet_fragments_get(struct hubble_sat_packet *packets,
+				    size_t *count, uint64_t device_id,
+				    const void *message, size_t length)
+{
+	int ret;
+	int fragments;
+	size_t last_length, last_size;
+	const struct _size_class *size_class;
+	uint16_t sequence_number;
+	const uint8_t *data = message;
+	uint8_t fragment[HUBBLE_PAYLOAD_MAX_SIZE];
+	struct hubble_sat_packet_template tmpl, tmpl_last;
+
+	if ((packets == NULL) || (count == NULL) ||
+	    ((message == NULL) && (length > 0U))) {
+		return -EINVAL;
+	}
+
+	fragments = hubble_sat_packet_fragments_count(length);
+	_CHECK_RET(fragments);
+
+	if ((size_t)fragments > *count) {
+		return -ENOMEM;
+	}
+
+	/* Every fragment but the last one uses the largest payload size */
+	if ((fragments > 1) &&
+	    (_size_class_get(HUBBLE_PAYLOAD_MAX_SIZE) == NULL)) {
+		return -ENOTSUP;
+	}
+
+	last_length = length -
+		      ((fragments - 1) * HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX);
+	/* Smallest payload size that fits the last fragment. The header
+	 * only has room for a few padding bytes, which is not enough when
+	 * the custom payload sizes leave large gaps.
 	 */
-	memcpy(&symbols[ret], rs_symbols, ecc * sizeof(int));
+	size_class = _size_class_fit_get(last_length +
+					 HUBBLE_SAT_FRAGMENT_HEADER_SIZE);
+	if ((size_class == NULL) ||
+	    ((size_class->length - last_length -
+	      HUBBLE_SAT_FRAGMENT_HEADER_SIZE) > _FRAGMENT_PADDING_MAX)) {
+		return -ENOTSUP;
+	}
+	last_size = size_class->length;
 
-	/* data whitening symbols before add them to the packet */
-	ret = _whitening(packet->channel, symbols, ret + ecc);
+	/* Only the last fragment can be smaller, so at most two templates
+	 * are needed for the whole message.
+	 */
+	if (fragments > 1) {
+		ret = hubble_sat_packet_template_init(&tmpl, device_id,
+						      HUBBLE_PAYLOAD_MAX_SIZE);
+		_CHECK_RET(ret);
+	}
+
+	ret = hubble_sat_packet_template_init(&tmpl_last, device_id, last_size);
 	_CHECK_RET(ret);
 
-	for (uint8_t i = 0; i < payload_symbols_length + ecc; i++) {
-		packet->data[packet->length + i] = symbols[i];
+	ret = hubble_internal_sat_sequence_get(fragments, &sequence_number);
+	_CHECK_RET(ret);
+
+	for (int i = 0; i < fragments; i++) {
+		bool last = (i == (fragments - 1));
+		size_t chunk = last ? last_length
+				    : HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX;
+
+		memset(fragment, 0, sizeof(fragment));
+		fragment[0] = i << _FRAGMENT_INDEX_SHIFT;
+		if (last) {
+			fragment[0] |= _FRAGMENT_LAST |
+				       (last_size - chunk -
+					HUBBLE_SAT_FRAGMENT_HEADER_SIZE);
+		}
+
+		if (chunk > 0U) {
+			memcpy(&fragment[HUBBLE_SAT_FRAGMENT_HEADER_SIZE],
+			       &data[i * HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX], chunk);
+		}
+
+		ret = _packet_from_template_encode(&packets[i],
+						   last ? &tmpl_last : &tmpl,
+						   fragment, sequence_number + i);
+		_CHECK_RET(ret);
 	}
-	packet->length += payload_symbols_length + ecc;
 
-#undef _CHECK_RET
+	*count = fragments;
 
 	return 0;
 }
+
+/* Record header: tag (4 bits) | value length (4 bits) */
+#define _RECORD_TAG_SHIFT   4U
+#define _RECORD_LENGTH_MASK 0x0FU
+
+int hubble_sat_aggregator_init(struct hubble_sat_aggregator *agg,
+			       uint64_t device_id, void *buffer, size_t size,
+			       size_t threshold, uint32_t max_delay_ms)
+{
+	if ((agg == NULL) || (buffer == NULL) || (size == 0U)) {
+		return -EINVAL;
+	}
+
+	*agg = (struct hubble_sat_aggregator){
+		.buffer = buffer,
+		.size = size,
+		.threshold = threshold,
+		.dev_id = device_id,
+		.max_delay_ms = max_delay_ms,
+	};
+
+	return 0;
+}
+
+/* Packs the records in as few payloads of the largest enabled size as
+ * possible (first fit decreasing). Payloads are only written when given.
+ * Returns the number of payloads used.
+ */
+static int _aggregator_pack(const struct hubble_sat_aggregator *agg,
+			    uint8_t payloads[][HUBBLE_PAYLOAD_MAX_SIZE],
+			    uint8_t fill[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX])
+{
+	int bins = 0;
+	size_t bin_size = _size_class_max_get();
+
+	memset(fill, 0, HUBBLE_SAT_AGGREGATOR_PACKETS_MAX);
+
+	for (size_t size = bin_size; size > 0U; size--) {
+		size_t record_size;
+
+		for (size_t i = 0; i < agg->length; i += record_size) {
+			int bin;
+
+			record_size = HUBBLE_SAT_RECORD_HEADER_SIZE +
+				      (agg->buffer[i] & _RECORD_LENGTH_MASK);
+			if (record_size != size) {
+				continue;
+			}
+
+			for (bin = 0; bin < bins; bin++) {
+				if ((fill[bin] + size) <= bin_size) {
+					break;
+				}
+			}
+
+			if (bin == bins) {
+				if (bins == HUBBLE_SAT_AGGREGATOR_PACKETS_MAX) {
+					return -ENOMEM;
+				}
+				bins++;
+			}
+
+			if (payloads != NULL) {
+				memcpy(&payloads[bin][fill[bin]],
+				       &agg->buffer[i], size);
+			}
+			fill[bin] += size;
+		}
+	}
+
+	return bins;
+}
+
+int hubble_sat_aggregator_add(struct hubble_sat_aggregator *agg, uint8_t tag,
+			      const void *value, size_t length)
+{
+	int ret;
+	size_t previous_length;
+	uint8_t fill[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+
+	if ((agg == NULL) || (tag == 0U) || (tag > HUBBLE_SAT_RECORD_TAG_MAX) ||
+	    (length > HUBBLE_SAT_RECORD_VALUE_MAX) ||
+	    ((value == NULL) && (length > 0U))) {
+		return -EINVAL;
+	}
+
+	/* The record must fit in the largest enabled payload size */
+	if ((HUBBLE_SAT_RECORD_HEADER_SIZE + length) > _size_class_max_get()) {
+		return -EINVAL;
+	}
+
+	if ((agg->length + HUBBLE_SAT_RECORD_HEADER_SIZE + length) > agg->size) {
+		return -ENOMEM;
+	}
+
+	previous_length = agg->length;
+	agg->buffer[agg->length++] = (tag << _RECORD_TAG_SHIFT) | length;
+	if (length > 0U) {
+		memcpy(&agg->buffer[agg->length], value, length);
+		agg->length += length;
+	}
+
+	/* The record must also fit in the packets of a flush */
+	ret = _aggregator_pack(agg, NULL, fill);
+	if (ret < 0) {
+		agg->length = previous_length;
+		return ret;
+	}
+
+	if (previous_length == 0U) {
+		agg->deadline_ms = hubble_uptime_get() + agg->max_delay_ms;
+	}
+
+	return 0;
+}
+
+bool hubble_sat_aggregator_ready(const struct hubble_sat_aggregator *agg)
+{
+	if ((agg == NULL) || (agg->length == 0U)) {
+		return false;
+	}
+
+	if ((agg->threshold > 0U) && (agg->length >= agg->threshold)) {
+		return true;
+	}
+
+	return hubble_uptime_get() >= agg->deadline_ms;
+}
+
+int hubble_sat_aggregator_packets_count(const struct hubble_sat_aggregator *agg)
+{
+	uint8_t fill[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+
+	if (agg == NULL) {
+		return -EINVAL;
+	}
+
+	return _aggregator_pack(agg, NULL, fill);
+}
+
+int hubble_sat_aggregator_flush(struct hubble_sat_aggregator *agg,
+				struct hubble_sat_packet *packets,
+				size_t *count)
+{
+	int ret;
+	int bins;
+	const struct _size_class *size_class;
+	uint8_t fill[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+	/* Unused bytes stay zero, which ends the records of a payload */
+	uint8_t payloads[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX]
+			[HUBBLE_PAYLOAD_MAX_SIZE] = {0};
+
+	if ((agg == NULL) || (packets == NULL) || (count == NULL)) {
+		return -EINVAL;
+	}
+
+	bins = _aggregator_pack(agg, payloads, fill);
+	_CHECK_RET(bins);
+
+	if ((size_t)bins > *count) {
+		return -ENOMEM;
+	}
+
+	for (int i = 0; i < bins; i++) {
+		/* Smallest payload size that holds the records */
+		size_class = _size_class_fit_get(fill[i]);
+		if (size_class == NULL) {
+			return -EINVAL;
+		}
+
+		ret = hubble_sat_packet_get(&packets[i], agg->dev_id, payloads[i],
+					    size_class->length);
+		_CHECK_RET(ret);
+	}
+
+	*count = bins;
+	agg->length = 0U;
+
+	return 0;
+}
+
+#undef _CHECK_RET
@@ -12,6 +12,7 @@
 #include <hubble/port/sat_radio.h>
 #include <hubble/port/sys.h>
 
+#include "hubble_priv.h"
 #include "reed_solomon_encoder.h"
 #include "utils/bitarray.h"
 #include "utils/macros.h"
@@ -34,9 +35,6 @@
  */
 #define HUBBLE_MAC_LENGTH_SYMBOLS      3
 
-/* Number of bits to represent a symbol */
-#define HUBBLE_SYMBOL_SIZE             6
-
 #define HUBBLE_PACKET_FRAME_MAX_SIZE   25
 
 #define HUBBLE_SAT_CHANNEL_DEFAULT     5U
@@ -51,8 +49,6 @@ static const uint8_t _hubble_packet_total_symbols[] = {
 	24, 26, 30, 32, 36, 38, 42, 44,
 };
 
-static uint16_t _sequence_number;
-
 /* Returns the index (_hubble_packet_total_symbols) to the total number of
  * symbols needed for the packet.
  **/
@@ -83,7 +79,7 @@ static bool _payload_length_check(size_t length)
 			       8);
 }
 
-static int _encode(const struct hubble_bitarray *bit_array, int *symbols,
+static int _encode(const struct hubble_bitarray *bit_array, uint8_t *symbols,
 		   size_t symbols_size)
 {
 	uint8_t symbol = 0U;
@@ -121,8 +117,10 @@ int hubble_sat_packet_get(struct hubble_sat_packet *packet, uint64_t device_id,
 	uint8_t symbol_index;
 	uint8_t ecc;
 	uint8_t channel;
-	int symbols[HUBBLE_PACKET_FRAME_MAX_SIZE];
-	int *rs_symbols;
+	uint8_t symbols[HUBBLE_PACKET_FRAME_MAX_SIZE];
+	const uint8_t *rs_symbols;
+	uint16_t sequence_number;
+	uint8_t auth_tag[HUBBLE_AUTH_TAG_SIZE / HUBBLE_CHAR_BITS];
 
 	if (!_payload_length_check(length)) {
 		return -EINVAL;
@@ -138,17 +136,27 @@ int hubble_sat_packet_get(struct hubble_sat_packet *packet, uint64_t device_id,
 	}
 
 	/* Sequence number */
-	/* TODO: We need to protect _sequence_number  */
-	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&_sequence_number,
+	ret = hubble_internal_sat_sequence_get(1U, &sequence_number);
+	if (ret < 0) {
+		return ret;
+	}
+
+	sequence_number &= (1U << HUBBLE_SEQUENCE_NUMBER_SIZE) - 1U;
+	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&sequence_number,
 				     HUBBLE_SEQUENCE_NUMBER_SIZE);
 	if (ret < 0) {
 		return ret;
 	}
-	_sequence_number++;
 
 	/* Authentication tag */
-	ret = hubble_bitarray_append(&bit_array, (uint8_t *)&(uint16_t){0},
-				     HUBBLE_AUTH_TAG_SIZE);
+	ret = hubble_internal_sat_auth_tag_get(sequence_number, device_id,
+					       payload, length, auth_tag,
+					       sizeof(auth_tag));
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = hubble_bitarray_append(&bit_array, auth_tag, HUBBLE_AUTH_TAG_SIZE);
 	if (ret < 0) {
 		return ret;
 	}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <hubble/sat/pass_table.h>
+
+#include "utils/crc32.h"
+
+/* Offsets of the header fields */
+#define _PASS_TABLE_MAGIC_OFFSET    0U
+#define _PASS_TABLE_VERSION_OFFSET  4U
+#define _PASS_TABLE_COUNT_OFFSET    6U
+#define _PASS_TABLE_CRC_OFFSET      8U
+#define _PASS_TABLE_BASE_OFFSET     12U
+
+/* Offsets of the entry fields */
+#define _PASS_TABLE_START_OFFSET    0U
+#define _PASS_TABLE_DURATION_OFFSET 4U
+
+static uint64_t _le_get(const uint8_t *data, size_t len)
+{
+	uint64_t value = 0;
+
+	while (len-- > 0U) {
+		value = (value << 8) | data[len];
+	}
+
+	return value;
+}
+
+static uint64_t _entry_start_get(const struct hubble_pass_table *table,
+				 size_t index)
+{
+	const uint8_t *entry =
+		table->entries + (index * HUBBLE_PASS_TABLE_ENTRY_SIZE);
+
+	return table->base + _le_get(entry + _PASS_TABLE_START_OFFSET, 4);
+}
+
+static uint32_t _entry_duration_get(const struct hubble_pass_table *table,
+				    size_t index)
+{
+	const uint8_t *entry =
+		table->entries + (index * HUBBLE_PASS_TABLE_ENTRY_SIZE);
+
+	return (uint32_t)_le_get(entry + _PASS_TABLE_DURATION_OFFSET, 2);
+}
+
+int hubble_pass_table_open(struct hubble_pass_table *table, const void *data,
+			   size_t len)
+{
+	const uint8_t *header = data;
+	struct hubble_pass_table opened;
+	size_t entries_len;
+	uint64_t end = 0;
+
+	/* Basic sanity check */
+	if ((table == NULL) || (data == NULL)) {
+		return -EINVAL;
+	}
+
+	if ((len < HUBBLE_PASS_TABLE_HEADER_SIZE) ||
+	    (_le_get(header + _PASS_TABLE_MAGIC_OFFSET, 4) !=
+	     HUBBLE_PASS_TABLE_MAGIC)) {
+		return -EBADMSG;
+	}
+
+	if (header[_PASS_TABLE_VERSION_OFFSET] != HUBBLE_PASS_TABLE_VERSION) {
+		return -ENOTSUP;
+	}
+
+	opened.entries = header + HUBBLE_PASS_TABLE_HEADER_SIZE;
+	opened.count =
+		(uint16_t)_le_get(header + _PASS_TABLE_COUNT_OFFSET, 2);
+	opened.base = _le_get(header + _PASS_TABLE_BASE_OFFSET, 8);
+
+	entries_len = (size_t)opened.count * HUBBLE_PASS_TABLE_ENTRY_SIZE;
+	if ((len - HUBBLE_PASS_TABLE_HEADER_SIZE) < entries_len) {
+		return -EBADMSG;
+	}
+
+	if (hubble_crc32(opened.entries, entries_len) !=
+	    (uint32_t)_le_get(header + _PASS_TABLE_CRC_OFFSET, 4)) {
+		return -EBADMSG;
+	}
+
+	/* The lookup relies on the passes being sorted and disjoint, and
+	 * never matches an empty one.
+	 */
+	for (size_t i = 0; i < opened.count; i++) {
+		uint64_t start = _entry_start_get(&opened, i);
+		uint32_t duration = _entry_duration_get(&opened, i);
+
+		if ((duration == 0U) || ((i > 0U) && (start < end))) {
+			return -EBADMSG;
+		}
+		end = start + duration;
+	}
+
+	memcpy(table, &opened, sizeof(opened));
+
+	return 0;
+}
+
+size_t hubble_pass_table_count(const struct hubble_pass_table *table)
+{
+	if (table == NULL) {
+		return 0;
+	}
+
+	return table->count;
+}
+
+int hubble_next_pass_table_get(const struct hubble_pass_table *table,
+			       uint64_t t, struct hubble_pass_info *pass)
+{
+	size_t low = 0, high, mid;
+
+	/* Basic sanity check */
+	if ((table == NULL) || (pass == NULL)) {
+		return -EINVAL;
+	}
+
+	/* First pass that has not ended at t. The passes are disjoint, so
+	 * their ends are sorted like their starts.
+	 */
+	high = table->count;
+	while (low < high) {
+		mid = low + ((high - low) / 2);
+		if ((_entry_start_get(table, mid) +
+		     _entry_duration_get(table, mid)) > t) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+
+	if (low == table->count) {
+		return -ENOENT;
+	}
+
+	memset(pass, 0, sizeof(*pass));
+	pass->t = _entry_start_get(table, low);
+	pass->duration = _entry_duration_get(table, low);
+
+	return 0;
+}
@@ -55,9 +55,39 @@
 #define kkk 41 /* kk = nn-2*tt  */
 
 /* specify irreducible polynomial coeffts */
-static int pp[mm + 1] = {1, 1, 0, 0, 0, 0, 1};
-static int alpha_to[nn + 1], index_of[nn + 1], gg[nn - kkk + 1];
-static int bb[nn - kkk];
+static const uint8_t pp[mm + 1] = {1, 1, 0, 0, 0, 0, 1};
+/* Symbols are 6 bits, so every table fits in a byte. index_of[0] and
+   zero terms of gg[] in index form are -1, hence the signed tables.
+*/
+static uint8_t alpha_to[nn + 1];
+static int8_t index_of[nn + 1], gg[nn - kkk + 1];
+static uint8_t bb[nn - kkk];
+
+/* Constant form of the tables built by rse_gf_generate(). The exponent
+   table is repeated so the sum of two indexes does not need a modulo.
+*/
+const uint8_t rse_gf_exp[2 * nn] = {
+	1, 2, 4, 8, 16, 32, 3, 6, 12, 24, 48, 35,
+	5, 10, 20, 40, 19, 38, 15, 30, 60, 59, 53, 41,
+	17, 34, 7, 14, 28, 56, 51, 37, 9, 18, 36, 11,
+	22, 44, 27, 54, 47, 29, 58, 55, 45, 25, 50, 39,
+	13, 26, 52, 43, 21, 42, 23, 46, 31, 62, 63, 61,
+	57, 49, 33, 1, 2, 4, 8, 16, 32, 3, 6, 12,
+	24, 48, 35, 5, 10, 20, 40, 19, 38, 15, 30, 60,
+	59, 53, 41, 17, 34, 7, 14, 28, 56, 51, 37, 9,
+	18, 36, 11, 22, 44, 27, 54, 47, 29, 58, 55, 45,
+	25, 50, 39, 13, 26, 52, 43, 21, 42, 23, 46, 31,
+	62, 63, 61, 57, 49, 33,
+};
+
+const int8_t rse_gf_log[nn + 1] = {
+	-1, 0, 1, 6, 2, 12, 7, 26, 3, 32, 13, 35,
+	8, 48, 27, 18, 4, 24, 33, 16, 14, 52, 36, 54,
+	9, 45, 49, 38, 28, 41, 19, 56, 5, 62, 25, 11,
+	34, 31, 17, 47, 15, 23, 53, 51, 37, 44, 55, 40,
+	10, 61, 46, 30, 50, 22, 39, 43, 29, 60, 42, 21,
+	20, 59, 57, 58,
+};
 
 /* generate GF(2**mm) from the irreducible polynomial p(X) in pp[0]..pp[mm]
    lookup tables:  index->polynomial form   alpha_to[] contains j=alpha**i;
@@ -119,6 +149,16 @@ void rse_poly_generate(int tt)
 	}
 }
 
+/* multiply two elements of GF(2**mm) given in polynomial form */
+uint8_t rse_gf_mul(uint8_t a, uint8_t b)
+{
+	if ((a == 0) || (b == 0)) {
+		return 0;
+	}
+
+	return rse_gf_exp[rse_gf_log[a] + rse_gf_log[b]];
+}
+
 /* take the string of symbols in data[i], i=0..(k-1) and encode systematically
    to produce 2*tt parity symbols in bb[0]..bb[2*tt-1]
    data[] is input and bb[] is output in polynomial form.
@@ -126,9 +166,10 @@ void rse_poly_generate(int tt)
    connections specified by the elements of gg[], which was generated above.
    Codeword is   c(X) = data(X)*X**(nn-kk)+ b(X)
 */
-int *rse_rs_encode(int data[], int kk, int tt)
+const uint8_t *rse_rs_encode(const uint8_t data[], int kk, int tt)
 {
-	register int i, j, temp;
+	register int i, j;
+	uint8_t temp;
 	int feedback;
 
 	for (i = 0; i < 2 * tt; i++) {
@@ -7,6 +7,7 @@
 #ifndef SRC_REED_SOLOMON_ENCODER_H
 #define SRC_REED_SOLOMON_ENCODER_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -33,6 +34,22 @@ void rse_gf_generate(void);
  */
 void rse_poly_generate(int tt);
 
+/**
+ * @brief Multiplies two elements of the Galois Field.
+ *
+ * Reed-Solomon parity is linear over the field, so scaling the parity of a
+ * known codeword is enough to obtain the parity of a scaled input.
+ *
+ * @param[in] a First element in polynomial form.
+ * @param[in] b Second element in polynomial form.
+ *
+ * @return The product @p a * @p b in polynomial form.
+ *
+ * @note It uses constant tables, there is no need to call
+ *       ~rse_gf_generate~ first.
+ */
+uint8_t rse_gf_mul(uint8_t a, uint8_t b);
+
 /**
  * @brief Encodes the input data using the Reed-Solomon algorithm.
  *
@@ -49,6 +66,70 @@ void rse_poly_generate(int tt);
  * @note The total length of the encoded message is ~kk + 2 * tt~.
  *       The caller is responsible for managing the memory of the returned array.
  */
-int *rse_rs_encode(int data[], int kk, int tt);
+const uint8_t *rse_rs_encode(const uint8_t data[], int kk, int tt);
+
+/**
+ * @brief Exponent (index to polynomial form) table of GF(2**6).
+ *
+ * It holds two periods, so the sum of two indexes can be used without
+ * modulo.
+ */
+extern const uint8_t rse_gf_exp[126];
+
+/**
+ * @brief Logarithm (polynomial to index form) table of GF(2**6).
+ *
+ * The logarithm of 0 is -1.
+ */
+extern const int8_t rse_gf_log[64];
+
+/**
+ * @brief Define an encoder for a fixed code.
+ *
+ * It defines a static function @p _name that computes the @p _ecc parity
+ * symbols of @p _kk data symbols, in the same order as
+ * ~rse_rs_encode~:
+ *
+ * @code
+ * static void _name(const uint8_t data[_kk], uint8_t parity[_ecc]);
+ * @endcode
+ *
+ * Sizes and the generator polynomial are compile time constants, so the
+ * compiler can unroll the shift register feedback, and it only uses
+ * constant tables. Unlike ~rse_rs_encode~ it does not touch any global
+ * state and there is no need to generate the field or the polynomial.
+ *
+ * @param _name Name of the function.
+ * @param _kk   Number of data symbols.
+ * @param _ecc  Number of parity symbols (2 * tt).
+ * @param _gen  Generator polynomial, @p _ecc + 1 coefficients in index
+ *              form as built by ~rse_poly_generate~. All coefficients
+ *              must be non zero.
+ */
+#define RSE_RS_ENCODER_DEFINE(_name, _kk, _ecc, _gen)                          \
+	static void _name(const uint8_t *data, uint8_t *parity)                \
+	{                                                                      \
+		uint8_t bb[(_ecc)] = {0};                                      \
+                                                                               \
+		for (size_t i = 0; i < (_kk); i++) {                           \
+			int feedback =                                         \
+				rse_gf_log[data[i] ^ bb[(_ecc) - 1]];          \
+                                                                               \
+			for (size_t j = (_ecc) - 1; j > 0; j--) {              \
+				bb[j] = bb[j - 1];                             \
+				if (feedback >= 0) {                           \
+					bb[j] ^= rse_gf_exp[(_gen)[j] +        \
+							    feedback];         \
+				}                                              \
+			}                                                      \
+			bb[0] = (feedback >= 0)                                \
+					? rse_gf_exp[(_gen)[0] + feedback]     \
+					: 0;                                   \
+		}                                                              \
+                                                                               \
+		for (size_t i = 0; i < (_ecc); i++) {                          \
+			parity[i] = bb[(_ecc) - 1 - i];                        \
+		}                                                              \
+	}
 
 #endif /* SRC_REED_SOLOMON_ENCODER_H */
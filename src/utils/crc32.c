@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crc32.h"
+
+/* Reflected polynomial of the CRC-32 (IEEE 802.3) */
+#define HUBBLE_CRC32_POLY 0xEDB88320U
+
+/* Bitwise, the data is only checked once when it is opened */
+uint32_t hubble_crc32(const uint8_t *data, size_t len)
+{
+	uint32_t crc = 0xFFFFFFFFU;
+
+	for (size_t i = 0; i < len; i++) {
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8U; bit++) {
+			crc = (crc >> 1) ^ (HUBBLE_CRC32_POLY & (0U - (crc & 1U)));
+		}
+	}
+
+	return ~crc;
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SRC_UTILS_CRC32_H
+#define SRC_UTILS_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Compute the CRC-32 (IEEE 802.3) of a buffer.
+ *
+ * Same as zlib's crc32(), used by the tools generating the data.
+ *
+ * @param data Pointer to the data.
+ * @param len  Size of @p data in bytes.
+ *
+ * @return The CRC-32 of @p data.
+ */
+uint32_t hubble_crc32(const uint8_t *data, size_t len);
+
+#endif /* SRC_UTILS_CRC32_H */
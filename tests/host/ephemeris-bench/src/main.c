@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2025 Hubble Network
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host benchmark of the ephemeris engine.
+ *
+ * It sweeps a grid of locations, regions and start times against the
+ * orbit of tests/zephyr/ephemeris, timing every query in the libm and
+ * in the small builds, and prints the throughput, the latency and the
+ * pass time error of the small build as JSON.
+ *
+ * Usage: ephemeris_bench [-r rounds] [-e max_error_s]
+ *
+ * With -e it fails when the small build misses a pass found by the
+ * libm build (or the other way around) or when a pass time differs by
+ * more than max_error_s seconds.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hubble/sat/ephemeris.h>
+
+#include "orbit.h"
+
+#ifndef EPHEMERIS_BENCH_SMALL_OPTIONS
+#define EPHEMERIS_BENCH_SMALL_OPTIONS "CONFIG_HUBBLE_SAT_NETWORK_SMALL"
+#endif
+
+/* Grid swept by the benchmark */
+#define BENCH_LAT_MIN      (-80)
+#define BENCH_LAT_MAX      80
+#define BENCH_LAT_STEP     10
+#define BENCH_LON_STEP     15
+#define BENCH_REGION_STEP  15
+#define BENCH_REGION_SIZE  10.0
+#define BENCH_TIMES        16
+/* Not a multiple of the orbital period nor of a day */
+#define BENCH_TIME_STEP    75437
+
+#define BENCH_POINTS                                                           \
+	((((BENCH_LAT_MAX - BENCH_LAT_MIN) / BENCH_LAT_STEP) + 1) *            \
+	 (360 / BENCH_LON_STEP) * BENCH_TIMES)
+#define BENCH_REGIONS                                                          \
+	((((BENCH_LAT_MAX - BENCH_LAT_MIN) / BENCH_REGION_STEP) + 1) *         \
+	 (360 / BENCH_REGION_STEP) * BENCH_TIMES)
+
+/* Small build of the engine, see CMakeLists.txt */
+int hubble_small_next_pass_get(const struct orbit_info *orbit, uint64_t t,
+			       const struct ground_info *ground,
+			       struct hubble_pass_info *pass);
+int hubble_small_next_pass_region_get(const struct orbit_info *orbit,
+				      uint64_t t,
+				      const struct ground_region_info *region,
+				      struct hubble_pass_info *pass);
+
+struct bench_query {
+	uint64_t t;
+	struct ground_info ground;
+	struct ground_region_info region;
+};
+
+struct bench_result {
+	int ret;
+	uint64_t t;
+};
+
+struct bench_engine {
+	const char *name;
+	int (*next_pass_get)(const struct orbit_info *orbit, uint64_t t,
+			     const struct ground_info *ground,
+			     struct hubble_pass_info *pass);
+	int (*next_pass_region_get)(const struct orbit_info *orbit, uint64_t t,
+				    const struct ground_region_info *region,
+				    struct hubble_pass_info *pass);
+};
+
+static const struct bench_engine _engines[] = {
+	{"libm", hubble_next_pass_get, hubble_next_pass_region_get},
+	{"small", hubble_small_next_pass_get,
+	 hubble_small_next_pass_region_get},
+};
+
+#define BENCH_ENGINES (sizeof(_engines) / sizeof(_engines[0]))
+
+static struct bench_query _points[BENCH_POINTS];
+static struct bench_query _regions[BENCH_REGIONS];
+
+static struct bench_result _results[BENCH_ENGINES][BENCH_POINTS];
+static struct bench_result _region_results[BENCH_ENGINES][BENCH_REGIONS];
+
+/* Scratch buffer, large enough for the latencies of all rounds */
+static uint64_t *_samples;
+
+static uint64_t _now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static int _u64_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Nearest rank percentile of sorted samples */
+static uint64_t _percentile(const uint64_t *sorted, size_t n, unsigned int p)
+{
+	size_t rank;
+
+	if (n == 0) {
+		return 0;
+	}
+
+	rank = ((n * p) + 99) / 100;
+
+	return sorted[(rank == 0) ? 0 : rank - 1];
+}
+
+static void _grid_init(void)
+{
+	size_t n = 0;
+
+	for (int k = 0; k < BENCH_TIMES; k++) {
+		uint64_t t = orbit.t0 + ((uint64_t)k * BENCH_TIME_STEP);
+
+		for (int lat = BENCH_LAT_MIN; lat <= BENCH_LAT_MAX;
+		     lat += BENCH_LAT_STEP) {
+			for (int lon = -180; lon < 180; lon += BENCH_LON_STEP) {
+				_points[n].t = t;
+				_points[n].ground.lat = lat;
+				_points[n].ground.lon = lon;
+				n++;
+			}
+		}
+	}
+
+	n = 0;
+	for (int k = 0; k < BENCH_TIMES; k++) {
+		uint64_t t = orbit.t0 + ((uint64_t)k * BENCH_TIME_STEP);
+
+		for (int lat = BENCH_LAT_MIN; lat <= BENCH_LAT_MAX;
+		     lat += BENCH_REGION_STEP) {
+			for (int lon = -180; lon < 180;
+			     lon += BENCH_REGION_STEP) {
+				_regions[n].t = t;
+				_regions[n].region.lat_mid = lat;
+				_regions[n].region.lat_range = BENCH_REGION_SIZE;
+				_regions[n].region.lon_mid = lon;
+				_regions[n].region.lon_range = BENCH_REGION_SIZE;
+				n++;
+			}
+		}
+	}
+}
+
+/* Runs all queries of a kind and prints their timing */
+static void _run(const struct bench_engine *engine, bool region,
+		 unsigned int rounds, struct bench_result *results)
+{
+	const struct bench_query *queries = region ? _regions : _points;
+	size_t n = region ? BENCH_REGIONS : BENCH_POINTS;
+	size_t calls = n * rounds;
+	uint64_t total = 0;
+
+	for (unsigned int r = 0; r < rounds; r++) {
+		for (size_t i = 0; i < n; i++) {
+			struct hubble_pass_info pass = {0};
+			uint64_t start = _now_ns();
+			int ret;
+
+			if (region) {
+				ret = engine->next_pass_region_get(
+					&orbit, queries[i].t,
+					&queries[i].region, &pass);
+			} else {
+				ret = engine->next_pass_get(&orbit,
+							    queries[i].t,
+							    &queries[i].ground,
+							    &pass);
+			}
+
+			_samples[(r * n) + i] = _now_ns() - start;
+			total += _samples[(r * n) + i];
+			results[i].ret = ret;
+			results[i].t = pass.t;
+		}
+	}
+
+	qsort(_samples, calls, sizeof(_samples[0]), _u64_cmp);
+
+	printf("      \"%s\": {\n", region ? "region" : "point");
+	printf("        \"calls\": %zu,\n", calls);
+	printf("        \"calls_per_sec\": %.0f,\n",
+	       (total == 0) ? 0.0 : (calls * 1e9) / (double)total);
+	printf("        \"latency_ns\": {\"p50\": %" PRIu64
+	       ", \"p99\": %" PRIu64 ", \"max\": %" PRIu64 "}\n",
+	       _percentile(_samples, calls, 50),
+	       _percentile(_samples, calls, 99), _samples[calls - 1]);
+	printf("      }%s\n", region ? "" : ",");
+}
+
+/* Compares the passes of the small build against the libm build.
+ * Queries failing in both builds are not compared. Returns the number
+ * of queries failing in one build only or exceeding max_error.
+ */
+static size_t _compare(const char *name, const struct bench_result *ref,
+		       const struct bench_result *small, size_t n,
+		       uint64_t max_error, bool last)
+{
+	size_t compared = 0;
+	size_t failed = 0;
+	size_t missed = 0;
+	size_t exceeded = 0;
+	uint64_t sum = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		uint64_t err;
+
+		if ((ref[i].ret != 0) || (small[i].ret != 0)) {
+			if (ref[i].ret != small[i].ret) {
+				missed++;
+			} else {
+				failed++;
+			}
+			continue;
+		}
+
+		err = (ref[i].t > small[i].t) ? ref[i].t - small[i].t
+					      : small[i].t - ref[i].t;
+		if (err > max_error) {
+			exceeded++;
+		}
+		sum += err;
+		_samples[compared++] = err;
+	}
+
+	qsort(_samples, compared, sizeof(_samples[0]), _u64_cmp);
+
+	printf("    \"%s\": {\n", name);
+	printf("      \"compared\": %zu,\n", compared);
+	printf("      \"failed\": %zu,\n", failed);
+	printf("      \"missed\": %zu,\n", missed);
+	printf("      \"mean\": %.3f,\n",
+	       (compared == 0) ? 0.0 : (double)sum / compared);
+	printf("      \"p50\": %" PRIu64 ",\n",
+	       _percentile(_samples, compared, 50));
+	printf("      \"p99\": %" PRIu64 ",\n",
+	       _percentile(_samples, compared, 99));
+	printf("      \"max\": %" PRIu64 "\n",
+	       (compared == 0) ? 0 : _samples[compared - 1]);
+	printf("    }%s\n", last ? "" : ",");
+
+	return missed + exceeded;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int rounds = 1;
+	uint64_t max_error = UINT64_MAX;
+	size_t failures;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "r:e:")) != -1) {
+		switch (opt) {
+		case 'r':
+			rounds = (unsigned int)strtoul(optarg, NULL, 10);
+			break;
+		case 'e':
+			max_error = strtoull(optarg, NULL, 10);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-r rounds] [-e max_error_s]\n",
+				argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (rounds == 0) {
+		rounds = 1;
+	}
+
+	_samples = malloc(sizeof(_samples[0]) *
+			  (size_t)rounds * BENCH_POINTS);
+	if (_samples == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	_grid_init();
+
+	printf("{\n");
+	printf("  \"small_options\": \"%s\",\n", EPHEMERIS_BENCH_SMALL_OPTIONS);
+	printf("  \"grid\": {\"points\": %d, \"regions\": %d, \"rounds\": %u},\n",
+	       BENCH_POINTS, BENCH_REGIONS, rounds);
+	printf("  \"engines\": {\n");
+	for (size_t e = 0; e < BENCH_ENGINES; e++) {
+		printf("    \"%s\": {\n", _engines[e].name);
+		_run(&_engines[e], false, rounds, _results[e]);
+		_run(&_engines[e], true, rounds, _region_results[e]);
+		printf("    }%s\n", (e == BENCH_ENGINES - 1) ? "" : ",");
+	}
+	printf("  },\n");
+
+	printf("  \"pass_error_s\": {\n");
+	failures = _compare("point", _results[0], _results[1], BENCH_POINTS,
+			    max_error, false);
+	failures += _compare("region", _region_results[0],
+			     _region_results[1], BENCH_REGIONS, max_error,
+			     true);
+	printf("  }\n");
+	printf("}\n");
+
+	free(_samples);
+
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2026 Hubble Network, Inc.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Round trip tests of tools/sat_reassemble.py.
+
+The fragments are the payloads hubble_sat_packet_fragments_get() gives
+for a 40 bytes message (1, 2, ..., 40), checked by test_packet_fragments
+in tests/zephyr/sat-api.
+"""
+
+import os
+import sys
+import unittest
+
+from click.testing import CliRunner
+
+sys.path.insert(
+    0, os.path.join(os.path.dirname(__file__), "..", "..", "..", "tools")
+)
+
+import sat_reassemble  # noqa: E402
+
+MESSAGE = bytes(range(1, 41))
+
+FRAGMENTS = [
+    bytes([0x00]) + MESSAGE[0:12],
+    bytes([0x10]) + MESSAGE[12:24],
+    bytes([0x20]) + MESSAGE[24:36],
+    # Last fragment: 4 bytes and 4 padding bytes
+    bytes([0x3C]) + MESSAGE[36:40] + bytes(4),
+]
+
+DEVICE = "1337"
+
+
+class ReassemblerTest(unittest.TestCase):
+    def _add_all(self, reassembler, device, first, order):
+        messages = []
+        for index in order:
+            seq = (first + index) % sat_reassemble.SEQUENCE_NUMBER_MOD
+            message = reassembler.add(device, seq, FRAGMENTS[index])
+            if message is not None:
+                messages.append(message)
+        return messages
+
+    def test_in_order(self):
+        reassembler = sat_reassemble.Reassembler()
+        messages = self._add_all(reassembler, DEVICE, 42, range(4))
+        self.assertEqual(messages, [MESSAGE])
+
+    def test_out_of_order(self):
+        reassembler = sat_reassemble.Reassembler()
+        messages = self._add_all(reassembler, DEVICE, 42, [3, 1, 0, 2])
+        self.assertEqual(messages, [MESSAGE])
+
+    def test_sequence_wraparound(self):
+        reassembler = sat_reassemble.Reassembler()
+        messages = self._add_all(reassembler, DEVICE, 1022, range(4))
+        self.assertEqual(messages, [MESSAGE])
+
+    def test_interleaved(self):
+        reassembler = sat_reassemble.Reassembler()
+        messages = []
+        for index in range(4):
+            for device, first in ((DEVICE, 42), ("cafe", 42), (DEVICE, 100)):
+                messages += self._add_all(reassembler, device, first, [index])
+        self.assertEqual(messages, [MESSAGE] * 3)
+
+    def test_incomplete(self):
+        reassembler = sat_reassemble.Reassembler()
+        messages = self._add_all(reassembler, DEVICE, 42, [0, 1, 3])
+        self.assertEqual(messages, [])
+
+    def test_invalid(self):
+        reassembler = sat_reassemble.Reassembler()
+        with self.assertRaises(ValueError):
+            reassembler.add(DEVICE, 0, b"")
+        with self.assertRaises(ValueError):
+            reassembler.add(DEVICE, 0, bytes([0x0D, 0x01]))
+
+    def test_cli(self):
+        lines = [
+            f"{DEVICE} {(1022 + i) % 1024} {fragment.hex()}"
+            for i, fragment in enumerate(FRAGMENTS)
+        ]
+        result = CliRunner().invoke(
+            sat_reassemble.main, input="\n".join(lines)
+        )
+        self.assertEqual(result.exit_code, 0, result.output)
+        self.assertEqual(result.output, f"{DEVICE} {MESSAGE.hex()}\n")
+
+        result = CliRunner().invoke(sat_reassemble.main, input="1337 0\n")
+        self.assertNotEqual(result.exit_code, 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -8,6 +8,8 @@
 #include <zephyr/types.h>
 #include <zephyr/ztest.h>
 
+#include "orbit.h"
+
 #define EPHEMERIS_DELTA (3)
 
 struct test_result {
@@ -99,18 +101,6 @@ static const struct test_result results[] = {
 	{{0.0, 180.0}, 1711310392, 1711419026},
 };
 
-static const struct orbit_info orbit = {
-	.t0 = 1711296587,
-	.n0 = 0.00017559780215620866,     /* orbital frequency in orbits/sec */
-	.ndot = 3.6984685877857914e-14,
-	.raan0 = -2.62346138227064,
-	.raandot = 1.992330418167161e-07, /* approximation */
-	.aop0 = 3.523598389978097,
-	.aopdot = -6.981828658074634e-07, /* approximation */
-	.inclination = 97.4608,
-	.eccentricity = 0.0010652
-};
-
 ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_calculation)
 {
 	int ret;
@@ -126,6 +116,71 @@ ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_calculation)
 	}
 }
 
+struct test_window_result {
+	struct ground_info pos;
+	uint64_t start_time;
+	uint64_t window_start;
+	uint64_t max_elevation_time;
+	uint64_t window_end;
+	double max_elevation;
+};
+
+/* Found scanning the satellite elevation second by second */
+static const struct test_window_result window_results[] = {
+	{{47.0, -122.0}, 1713531547, 1713564595, 1713564691, 1713564786, 55.77},
+	{{47.0, 122.0}, 1713760281, 1713854895, 1713854941, 1713854987, 33.33},
+	{{-47.0, 0.0}, 1712196858, 1712325081, 1712325125, 1712325168, 32.84},
+};
+
+ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_window)
+{
+	int ret;
+	struct hubble_pass_info next_pass;
+	struct hubble_pass_window_info window;
+
+	for (uint16_t count = 0; count < ARRAY_SIZE(window_results); count++) {
+		ret = hubble_next_pass_window_get(
+			&orbit, window_results[count].start_time,
+			&(window_results[count].pos), &window);
+		zassert_equal(ret, 0, NULL);
+
+		ret = hubble_next_pass_get(&orbit,
+					   window_results[count].start_time,
+					   &(window_results[count].pos),
+					   &next_pass);
+		zassert_equal(ret, 0, NULL);
+		zassert_equal(window.pass.t, next_pass.t);
+		zassert_equal(window.pass.ascending, next_pass.ascending);
+
+		zassert_within(window.start, window_results[count].window_start,
+			       EPHEMERIS_DELTA);
+		zassert_within(window.end, window_results[count].window_end,
+			       EPHEMERIS_DELTA);
+		zassert_within(window.max_elevation_t,
+			       window_results[count].max_elevation_time,
+			       EPHEMERIS_DELTA);
+		zassert_within(window.max_elevation,
+			       window_results[count].max_elevation, 0.1);
+	}
+
+	/* The window is around the pass */
+	for (uint16_t count = 0; count < ARRAY_SIZE(results); count++) {
+		ret = hubble_next_pass_window_get(&orbit,
+						  results[count].start_time,
+						  &(results[count].pos), &window);
+		zassert_equal(ret, 0, NULL);
+		zassert_true(window.start <= window.max_elevation_t);
+		zassert_true(window.max_elevation_t <= window.end);
+		zassert_true(window.start <= (window.pass.t + EPHEMERIS_DELTA));
+		zassert_true((window.end + EPHEMERIS_DELTA) >= window.pass.t);
+		zassert_true(window.max_elevation <= 90.0);
+	}
+
+	ret = hubble_next_pass_window_get(&orbit, results[0].start_time,
+					  &(results[0].pos), NULL);
+	zassert_equal(ret, -EINVAL, NULL);
+}
+
 ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_invalid)
 {
 	struct hubble_pass_info next_pass;
@@ -144,6 +199,140 @@ ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_invalid)
 	zassert_equal(ret, -EINVAL, NULL);
 }
 
+ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_multi)
+{
+	int ret;
+	size_t count, indexes[3];
+	struct orbit_info orbits[5];
+	struct hubble_pass_info passes[3], next_pass;
+	uint64_t last_t = 0;
+
+	/* Same orbit with the planes spread around the Earth */
+	for (size_t i = 0; i < ARRAY_SIZE(orbits); i++) {
+		orbits[i] = orbit;
+		orbits[i].raan0 += i * 1.2;
+	}
+
+	count = 0;
+	ret = hubble_next_pass_multi_get(orbits, ARRAY_SIZE(orbits),
+					 results[0].start_time,
+					 &(results[0].pos), passes, indexes,
+					 &count);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	count = ARRAY_SIZE(passes);
+	ret = hubble_next_pass_multi_get(orbits, ARRAY_SIZE(orbits),
+					 results[0].start_time, NULL, passes,
+					 indexes, &count);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	ret = hubble_next_pass_multi_get(orbits, 0, results[0].start_time,
+					 &(results[0].pos), passes, indexes,
+					 &count);
+	zassert_equal(ret, -EINVAL, NULL);
+	zassert_equal(count, ARRAY_SIZE(passes), NULL);
+
+	ret = hubble_next_pass_multi_get(NULL, ARRAY_SIZE(orbits),
+					 results[0].start_time,
+					 &(results[0].pos), passes, indexes,
+					 &count);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	ret = hubble_next_pass_multi_get(orbits, ARRAY_SIZE(orbits),
+					 results[0].start_time,
+					 &(results[0].pos), NULL, indexes,
+					 &count);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	ret = hubble_next_pass_multi_get(orbits, ARRAY_SIZE(orbits),
+					 results[0].start_time,
+					 &(results[0].pos), passes, indexes,
+					 NULL);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	ret = hubble_next_pass_multi_get(orbits, ARRAY_SIZE(orbits),
+					 results[0].start_time,
+					 &(results[0].pos), passes, indexes,
+					 &count);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(count, ARRAY_SIZE(passes), NULL);
+
+	for (size_t i = 0; i < count; i++) {
+		zassert_true(passes[i].t >= last_t, NULL);
+		last_t = passes[i].t;
+
+		ret = hubble_next_pass_get(&orbits[indexes[i]],
+					   results[0].start_time,
+					   &(results[0].pos), &next_pass);
+		zassert_equal(ret, 0, NULL);
+		zassert_equal(next_pass.t, passes[i].t, NULL);
+	}
+
+	/* No other satellite passes before the last one returned */
+	for (size_t i = 0; i < ARRAY_SIZE(orbits); i++) {
+		ret = hubble_next_pass_get(&orbits[i], results[0].start_time,
+					   &(results[0].pos), &next_pass);
+		zassert_equal(ret, 0, NULL);
+		zassert_true((next_pass.t >= last_t) ||
+				     (next_pass.t == passes[0].t) ||
+				     (next_pass.t == passes[1].t),
+			     NULL);
+	}
+
+	/* The earliest pass of the constellation */
+	count = 1;
+	ret = hubble_next_pass_multi_get(orbits, ARRAY_SIZE(orbits),
+					 results[0].start_time,
+					 &(results[0].pos), &next_pass, NULL,
+					 &count);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(count, 1, NULL);
+	zassert_equal(next_pass.t, passes[0].t, NULL);
+}
+
+ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_iter)
+{
+	int ret;
+	uint64_t t;
+	struct hubble_pass_iter iter;
+	struct hubble_pass_info next_pass, iter_pass;
+
+	ret = hubble_pass_iter_init(NULL, &orbit, results[0].start_time,
+				    &(results[0].pos));
+	zassert_equal(ret, -EINVAL, NULL);
+
+	ret = hubble_pass_iter_init(&iter, &orbit, results[0].start_time,
+				    NULL);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	for (uint16_t count = 0; count < ARRAY_SIZE(results); count += 10) {
+		ret = hubble_pass_iter_init(&iter, &orbit,
+					    results[count].start_time,
+					    &(results[count].pos));
+		zassert_equal(ret, 0, NULL);
+
+		ret = hubble_pass_iter_next(&iter, NULL);
+		zassert_equal(ret, -EINVAL, NULL);
+
+		/* Same passes as searching from the previous one */
+		t = results[count].start_time;
+		for (uint8_t i = 0; i < 10; i++) {
+			ret = hubble_next_pass_get(&orbit, t,
+						   &(results[count].pos),
+						   &next_pass);
+			zassert_equal(ret, 0, NULL);
+
+			ret = hubble_pass_iter_next(&iter, &iter_pass);
+			zassert_equal(ret, 0, NULL);
+			zassert_equal(iter_pass.t, next_pass.t, NULL);
+			zassert_equal(iter_pass.ascending, next_pass.ascending,
+				      NULL);
+
+			t = next_pass.t;
+		}
+	}
+}
+
 struct test_region_result {
 	struct ground_region_info region;
 	uint64_t start_time;
@@ -178,4 +367,69 @@ ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_region_calculation)
 	}
 }
 
+ZTEST(satellite_ephemeris_test, test_satellite_ephemeris_regions)
+{
+	int ret, status[6];
+	size_t found;
+	struct hubble_pass_info passes[6], next_pass;
+	/* Zones sharing latitude bounds and one the satellite never sees */
+	static const struct ground_region_info regions[] = {
+		{1.0, 30.0, -45.0, 50.0},   {-45.0, 30.0, -45.0, 50.0},
+		{45.0, 30.0, -45.0, 50.0},  {45.0, 30.0, 100.0, 20.0},
+		{89.0, 2.0, 0.0, 10.0},     {1.0, 30.0, 170.0, 10.0},
+	};
+
+	ret = hubble_next_pass_regions_get(&orbit, region_results[0].start_time,
+					   regions, ARRAY_SIZE(regions), passes,
+					   status, &found);
+	zassert_equal(ret, 0, NULL);
+	zassert_equal(found, 5, NULL);
+
+	for (uint16_t count = 0; count < ARRAY_SIZE(regions); count++) {
+		ret = hubble_next_pass_region_get(&orbit,
+						  region_results[0].start_time,
+						  &regions[count], &next_pass);
+		if (ret != 0) {
+			zassert_equal(status[count], -ENOENT, NULL);
+			zassert_equal(passes[count].t, 0U, NULL);
+			continue;
+		}
+
+		zassert_equal(status[count], 0, NULL);
+		zassert_equal(passes[count].t, next_pass.t, NULL);
+		zassert_equal(passes[count].duration, next_pass.duration, NULL);
+		zassert_equal(passes[count].ascending, next_pass.ascending,
+			      NULL);
+	}
+
+	zassert_within(passes[0].t, region_results[0].next_pass_time,
+		       EPHEMERIS_DELTA);
+	zassert_within(passes[1].t, region_results[2].next_pass_time,
+		       EPHEMERIS_DELTA);
+	zassert_within(passes[2].t, region_results[4].next_pass_time,
+		       EPHEMERIS_DELTA);
+
+	ret = hubble_next_pass_regions_get(&orbit, region_results[0].start_time,
+					   regions, ARRAY_SIZE(regions), passes,
+					   NULL, NULL);
+	zassert_equal(ret, 0, NULL);
+
+	/* Only the region the satellite never sees */
+	ret = hubble_next_pass_regions_get(&orbit, region_results[0].start_time,
+					   &regions[4], 1, passes, status,
+					   &found);
+	zassert_equal(ret, -ENOENT, NULL);
+	zassert_equal(found, 0, NULL);
+	zassert_equal(status[0], -ENOENT, NULL);
+
+	ret = hubble_next_pass_regions_get(&orbit, region_results[0].start_time,
+					   regions, 0, passes, NULL, NULL);
+	zassert_equal(ret, -EINVAL, NULL);
+
+	ret = hubble_next_pass_regions_get(NULL, region_results[0].start_time,
+					   regions, ARRAY_SIZE(regions), passes,
+					   NULL, NULL);
+	zassert_equal(ret, -EINVAL, NULL);
+}
+
 ZTEST_SUITE(satellite_ephemeris_test, NULL, NULL, NULL, NULL, NULL);
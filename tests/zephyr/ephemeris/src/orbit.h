@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2025 Hubble Network
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TESTS_EPHEMERIS_ORBIT_H
+#define TESTS_EPHEMERIS_ORBIT_H
+
+#include <hubble/sat/ephemeris.h>
+
+/* Orbit the expected passes were generated with. It is also used by
+ * the host benchmark in tests/host/ephemeris-bench.
+ */
+static const struct orbit_info orbit = {
+	.t0 = 1711296587,
+	.n0 = 0.00017559780215620866,     /* orbital frequency in orbits/sec */
+	.ndot = 3.6984685877857914e-14,
+	.raan0 = -2.62346138227064,
+	.raandot = 1.992330418167161e-07, /* approximation */
+	.aop0 = 3.523598389978097,
+	.aopdot = -6.981828658074634e-07, /* approximation */
+	.inclination = 97.4608,
+	.eccentricity = 0.0010652
+};
+
+#endif /* TESTS_EPHEMERIS_ORBIT_H */
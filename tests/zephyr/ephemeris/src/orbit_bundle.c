@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <hubble/sat/orbit_bundle.h>
+#include <zephyr/types.h>
+#include <zephyr/ztest.h>
+
+#include "orbit.h"
+
+/* Generated with tools/orbit_bundle.py. Satellite 1 has two sets of
+ * elements, the first one is the orbit of the ephemeris tests. Satellite
+ * 2 is in another plane.
+ */
+static const uint8_t orbit_bundle[] __aligned(8) = {
+	0x48, 0x4f, 0x52, 0x42, 0x01, 0x00, 0x03, 0x00, 0x60, 0x00, 0x00, 0x00,
+	0xde, 0x50, 0xb6, 0x11, 0x4b, 0x50, 0x00, 0x66, 0x00, 0x00, 0x00, 0x00,
+	0xf1, 0xb8, 0x90, 0xa2, 0x15, 0x04, 0x27, 0x3f, 0x70, 0x28, 0xf0, 0x11,
+	0x0e, 0xd2, 0x24, 0x3d, 0xee, 0x5e, 0x39, 0x52, 0xd9, 0xfc, 0x04, 0xc0,
+	0x14, 0x5d, 0x71, 0x5e, 0x98, 0xbd, 0x8a, 0x3e, 0xaf, 0x8d, 0x49, 0x5a,
+	0x54, 0x30, 0x0c, 0x40, 0xc1, 0x2e, 0xc9, 0x5b, 0x58, 0x6d, 0xa7, 0xbe,
+	0xcc, 0x7f, 0x48, 0xbf, 0x7d, 0x5d, 0x58, 0x40, 0x36, 0x0c, 0x7a, 0xca,
+	0xc5, 0x73, 0x51, 0x3f, 0x4b, 0x50, 0x00, 0x66, 0x00, 0x00, 0x00, 0x00,
+	0xcb, 0x8a, 0x09, 0x66, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x4b, 0x50, 0x00, 0x66, 0x00, 0x00, 0x00, 0x00,
+	0xf1, 0xb8, 0x90, 0xa2, 0x15, 0x04, 0x27, 0x3f, 0x70, 0x28, 0xf0, 0x11,
+	0x0e, 0xd2, 0x24, 0x3d, 0xa9, 0x8a, 0x3f, 0x71, 0x7f, 0xc6, 0xf6, 0xbf,
+	0x14, 0x5d, 0x71, 0x5e, 0x98, 0xbd, 0x8a, 0x3e, 0xaf, 0x8d, 0x49, 0x5a,
+	0x54, 0x30, 0x0c, 0x40, 0xc1, 0x2e, 0xc9, 0x5b, 0x58, 0x6d, 0xa7, 0xbe,
+	0xcc, 0x7f, 0x48, 0xbf, 0x7d, 0x5d, 0x58, 0x40, 0x36, 0x0c, 0x7a, 0xca,
+	0xc5, 0x73, 0x51, 0x3f, 0x4b, 0x50, 0x00, 0x66, 0x00, 0x00, 0x00, 0x00,
+	0xcb, 0x8a, 0x09, 0x66, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xcb, 0xe7, 0x06, 0x66, 0x00, 0x00, 0x00, 0x00,
+	0xf1, 0xb8, 0x90, 0xa2, 0x15, 0x04, 0x27, 0x3f, 0x70, 0x28, 0xf0, 0x11,
+	0x0e, 0xd2, 0x24, 0x3d, 0x0b, 0xb9, 0x9d, 0x8d, 0xb8, 0x4c, 0x04, 0xc0,
+	0x14, 0x5d, 0x71, 0x5e, 0x98, 0xbd, 0x8a, 0x3e, 0x2d, 0xb2, 0x9d, 0xef,
+	0xa7, 0xc6, 0x09, 0x40, 0xc1, 0x2e, 0xc9, 0x5b, 0x58, 0x6d, 0xa7, 0xbe,
+	0xcc, 0x7f, 0x48, 0xbf, 0x7d, 0x5d, 0x58, 0x40, 0x36, 0x0c, 0x7a, 0xca,
+	0xc5, 0x73, 0x51, 0x3f, 0xcb, 0xe7, 0x06, 0x66, 0x00, 0x00, 0x00, 0x00,
+	0x4b, 0x22, 0x10, 0x66, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,
+};
+
+#define BUNDLE_T_FIRST  1711296587
+#define BUNDLE_T_SECOND 1711728587
+#define BUNDLE_T_END    1712333387
+
+static uint8_t buffer[sizeof(orbit_bundle) + 8] __aligned(8);
+
+ZTEST(orbit_bundle_test, test_orbit_bundle_records)
+{
+	int ret;
+	struct hubble_orbit_bundle bundle;
+	const struct hubble_orbit_record *record;
+
+	ret = hubble_orbit_bundle_open(&bundle, orbit_bundle,
+				       sizeof(orbit_bundle));
+	zassert_ok(ret);
+	zassert_equal(hubble_orbit_bundle_count(&bundle), 3U);
+
+	/* Records are not copied */
+	record = hubble_orbit_bundle_record_get(&bundle, 0);
+	zassert_equal_ptr(record,
+			  orbit_bundle + sizeof(struct hubble_orbit_bundle_header));
+	zassert_mem_equal(&record->orbit, &orbit, sizeof(orbit));
+	zassert_equal(record->id, 1U);
+	zassert_equal(record->valid_start, BUNDLE_T_FIRST);
+
+	record = hubble_orbit_bundle_record_get(&bundle, 1);
+	zassert_not_null(record);
+	zassert_equal(record->id, 2U);
+
+	zassert_is_null(hubble_orbit_bundle_record_get(&bundle, 3));
+	zassert_is_null(hubble_orbit_bundle_record_get(NULL, 0));
+	zassert_equal(hubble_orbit_bundle_count(NULL), 0U);
+}
+
+ZTEST(orbit_bundle_test, test_orbit_bundle_find)
+{
+	int ret;
+	struct hubble_orbit_bundle bundle;
+	const struct orbit_info *found;
+
+	ret = hubble_orbit_bundle_open(&bundle, orbit_bundle,
+				       sizeof(orbit_bundle));
+	zassert_ok(ret);
+
+	found = hubble_orbit_bundle_find(&bundle, 1, BUNDLE_T_FIRST);
+	zassert_equal_ptr(found,
+			  &hubble_orbit_bundle_record_get(&bundle, 0)->orbit);
+
+	/* Both sets of elements are valid, the most recent one is used */
+	found = hubble_orbit_bundle_find(&bundle, 1, BUNDLE_T_SECOND + 1);
+	zassert_equal_ptr(found,
+			  &hubble_orbit_bundle_record_get(&bundle, 2)->orbit);
+
+	found = hubble_orbit_bundle_find(&bundle, 2, BUNDLE_T_FIRST + 1);
+	zassert_equal_ptr(found,
+			  &hubble_orbit_bundle_record_get(&bundle, 1)->orbit);
+
+	zassert_is_null(hubble_orbit_bundle_find(&bundle, 2, BUNDLE_T_END));
+	zassert_is_null(hubble_orbit_bundle_find(&bundle, 1, BUNDLE_T_END + 1));
+	zassert_is_null(hubble_orbit_bundle_find(&bundle, 3, BUNDLE_T_FIRST));
+	zassert_is_null(
+		hubble_orbit_bundle_find(&bundle, 1, BUNDLE_T_FIRST - 1));
+}
+
+ZTEST(orbit_bundle_test, test_orbit_bundle_invalid)
+{
+	int ret;
+	struct hubble_orbit_bundle bundle;
+	struct hubble_orbit_bundle_header *header = (void *)buffer;
+	struct hubble_orbit_record *record =
+		(void *)(buffer + sizeof(struct hubble_orbit_bundle_header));
+
+	ret = hubble_orbit_bundle_open(NULL, orbit_bundle,
+				       sizeof(orbit_bundle));
+	zassert_equal(ret, -EINVAL);
+
+	ret = hubble_orbit_bundle_open(&bundle, NULL, sizeof(orbit_bundle));
+	zassert_equal(ret, -EINVAL);
+
+	/* Records could not be used in place */
+	memcpy(buffer + 4, orbit_bundle, sizeof(orbit_bundle));
+	ret = hubble_orbit_bundle_open(&bundle, buffer + 4,
+				       sizeof(orbit_bundle));
+	zassert_equal(ret, -EINVAL);
+
+	memcpy(buffer, orbit_bundle, sizeof(orbit_bundle));
+	ret = hubble_orbit_bundle_open(&bundle, buffer,
+				       sizeof(orbit_bundle) - 1);
+	zassert_equal(ret, -EBADMSG);
+
+	ret = hubble_orbit_bundle_open(&bundle, buffer, sizeof(*header) - 1);
+	zassert_equal(ret, -EBADMSG);
+
+	header->magic ^= 1U;
+	ret = hubble_orbit_bundle_open(&bundle, buffer, sizeof(orbit_bundle));
+	zassert_equal(ret, -EBADMSG);
+
+	memcpy(buffer, orbit_bundle, sizeof(orbit_bundle));
+	header->version++;
+	ret = hubble_orbit_bundle_open(&bundle, buffer, sizeof(orbit_bundle));
+	zassert_equal(ret, -ENOTSUP);
+
+	memcpy(buffer, orbit_bundle, sizeof(orbit_bundle));
+	header->record_size -= 8U;
+	ret = hubble_orbit_bundle_open(&bundle, buffer, sizeof(orbit_bundle));
+	zassert_equal(ret, -EBADMSG);
+
+	/* Corrupted elements */
+	memcpy(buffer, orbit_bundle, sizeof(orbit_bundle));
+	record->orbit.inclination += 1.0;
+	ret = hubble_orbit_bundle_open(&bundle, buffer, sizeof(orbit_bundle));
+	zassert_equal(ret, -EBADMSG);
+
+	/* A larger buffer is fine */
+	memcpy(buffer, orbit_bundle, sizeof(orbit_bundle));
+	ret = hubble_orbit_bundle_open(&bundle, buffer, sizeof(buffer));
+	zassert_ok(ret);
+	zassert_equal(hubble_orbit_bundle_count(&bundle), 3U);
+}
+
+ZTEST_SUITE(orbit_bundle_test, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+
+#include <hubble/sat/ephemeris.h>
+#include <zephyr/types.h>
+#include <zephyr/ztest.h>
+
+#include "hubble_priv.h"
+#include "orbit.h"
+
+/* The expected losses were computed in double precision with the same
+ * spherical model. The tolerance covers the approximations of the small
+ * builds.
+ */
+#define LOSS_TOLERANCE_DB 0.05
+
+ZTEST(pass_loss_test, test_pass_loss_along_track)
+{
+	static const struct ground_info ground = {47.0, -122.0};
+	static const struct hubble_pass_info pass = {
+		.lon = -122.0,
+		.t = 1711315802,
+		.duration = 600,
+	};
+	static const struct {
+		int64_t offset_s;
+		double loss_db;
+	} losses[] = {
+		{0, 0.0},     {60, 2.375},   {-60, 2.375},
+		{120, 5.919}, {300, 12.796}, {-300, 12.796},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(losses); i++) {
+		zassert_within(hubble_internal_pass_loss_db_get(
+				       &orbit, &ground, &pass,
+				       losses[i].offset_s),
+			       losses[i].loss_db, LOSS_TOLERANCE_DB,
+			       "offset %lld", (long long)losses[i].offset_s);
+	}
+
+	/* Below the horizon */
+	zassert_true(isinf(hubble_internal_pass_loss_db_get(&orbit, &ground,
+							    &pass, 600)));
+	zassert_true(isinf(hubble_internal_pass_loss_db_get(&orbit, &ground,
+							    &pass, -600)));
+}
+
+ZTEST(pass_loss_test, test_pass_loss_cross_track)
+{
+	static const struct ground_info equator = {0.0, 0.0};
+	static const struct ground_info north = {47.0, 0.0};
+	struct hubble_pass_info pass = {
+		.lon = 10.0,
+		.t = 1711315802,
+		.duration = 600,
+	};
+
+	zassert_within(
+		hubble_internal_pass_loss_db_get(&orbit, &equator, &pass, 0),
+		7.816, LOSS_TOLERANCE_DB);
+
+	/* Longitudes get closer away from the equator */
+	zassert_within(
+		hubble_internal_pass_loss_db_get(&orbit, &north, &pass, 0),
+		5.252, LOSS_TOLERANCE_DB);
+
+	/* Offsets wrap around the antimeridian */
+	pass.lon = 350.0;
+	zassert_within(
+		hubble_internal_pass_loss_db_get(&orbit, &equator, &pass, 0),
+		7.816, LOSS_TOLERANCE_DB);
+
+	pass.lon = 30.0;
+	zassert_true(isinf(
+		hubble_internal_pass_loss_db_get(&orbit, &equator, &pass, 0)));
+}
+
+ZTEST_SUITE(pass_loss_test, NULL, NULL, NULL, NULL, NULL);
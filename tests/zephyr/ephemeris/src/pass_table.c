@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <hubble/sat/pass_table.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/types.h>
+#include <zephyr/ztest.h>
+
+#include "utils/crc32.h"
+
+/* Generated with tools/pass_table from the bundle of orbit_bundle.c:
+ *
+ *   pass_table -r 40,10,-100,20 -s 1711296587 -d 172800 bundle.bin
+ */
+static const uint8_t pass_table[] = {
+	0x48, 0x50, 0x54, 0x42, 0x01, 0x00, 0x07, 0x00, 0xf8, 0x42, 0xee, 0x21,
+	0x4b, 0x50, 0x00, 0x66, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x4b, 0x00, 0x00,
+	0xa1, 0x00, 0xa5, 0xe0, 0x00, 0x00, 0xa1, 0x00, 0x61, 0x23, 0x01, 0x00,
+	0xa1, 0x00, 0xbc, 0x98, 0x01, 0x00, 0xa0, 0x00, 0x78, 0xdb, 0x01, 0x00,
+	0xa0, 0x00, 0x52, 0x2e, 0x02, 0x00, 0xa1, 0x00, 0x0e, 0x71, 0x02, 0x00,
+	0xa1, 0x00,
+};
+
+/* Same passes from hubble_next_pass_region_get() */
+static const struct {
+	uint64_t t;
+	uint32_t duration;
+} passes[] = {
+	{1711315802, 161}, {1711354096, 161}, {1711371180, 161},
+	{1711401223, 160}, {1711418307, 160}, {1711439517, 161},
+	{1711456601, 161},
+};
+
+/* Unaligned on purpose, tables have no alignment requirement */
+static uint8_t buffer[sizeof(pass_table) + 5];
+
+ZTEST(pass_table_test, test_pass_table_passes)
+{
+	int ret;
+	uint64_t t = 1711296587;
+	struct hubble_pass_table table;
+	struct hubble_pass_info pass;
+
+	memcpy(buffer + 1, pass_table, sizeof(pass_table));
+	ret = hubble_pass_table_open(&table, buffer + 1, sizeof(pass_table));
+	zassert_ok(ret);
+	zassert_equal(hubble_pass_table_count(&table), ARRAY_SIZE(passes));
+
+	for (size_t i = 0; i < ARRAY_SIZE(passes); i++) {
+		ret = hubble_next_pass_table_get(&table, t, &pass);
+		zassert_ok(ret);
+		zassert_equal(pass.t, passes[i].t);
+		zassert_equal(pass.duration, passes[i].duration);
+		zassert_equal(pass.lon, 0.0);
+		zassert_false(pass.ascending);
+		t = pass.t + pass.duration;
+	}
+
+	ret = hubble_next_pass_table_get(&table, t, &pass);
+	zassert_equal(ret, -ENOENT);
+}
+
+ZTEST(pass_table_test, test_pass_table_lookup)
+{
+	int ret;
+	struct hubble_pass_table table;
+	struct hubble_pass_info pass;
+
+	ret = hubble_pass_table_open(&table, pass_table, sizeof(pass_table));
+	zassert_ok(ret);
+
+	/* Before the first pass */
+	ret = hubble_next_pass_table_get(&table, 0, &pass);
+	zassert_ok(ret);
+	zassert_equal(pass.t, passes[0].t);
+
+	/* Pass in progress */
+	ret = hubble_next_pass_table_get(&table, passes[3].t, &pass);
+	zassert_ok(ret);
+	zassert_equal(pass.t, passes[3].t);
+
+	ret = hubble_next_pass_table_get(
+		&table, passes[3].t + passes[3].duration - 1, &pass);
+	zassert_ok(ret);
+	zassert_equal(pass.t, passes[3].t);
+
+	/* Pass just over */
+	ret = hubble_next_pass_table_get(
+		&table, passes[3].t + passes[3].duration, &pass);
+	zassert_ok(ret);
+	zassert_equal(pass.t, passes[4].t);
+	zassert_equal(pass.duration, passes[4].duration);
+
+	ret = hubble_next_pass_table_get(&table, passes[6].t + 1, &pass);
+	zassert_ok(ret);
+	zassert_equal(pass.t, passes[6].t);
+
+	ret = hubble_next_pass_table_get(&table, UINT64_MAX, &pass);
+	zassert_equal(ret, -ENOENT);
+
+	ret = hubble_next_pass_table_get(NULL, 0, &pass);
+	zassert_equal(ret, -EINVAL);
+
+	ret = hubble_next_pass_table_get(&table, 0, NULL);
+	zassert_equal(ret, -EINVAL);
+}
+
+ZTEST(pass_table_test, test_pass_table_invalid)
+{
+	int ret;
+	uint32_t crc;
+	struct hubble_pass_table table;
+
+	ret = hubble_pass_table_open(NULL, pass_table, sizeof(pass_table));
+	zassert_equal(ret, -EINVAL);
+
+	ret = hubble_pass_table_open(&table, NULL, sizeof(pass_table));
+	zassert_equal(ret, -EINVAL);
+
+	ret = hubble_pass_table_open(&table, pass_table,
+				     sizeof(pass_table) - 1);
+	zassert_equal(ret, -EBADMSG);
+
+	ret = hubble_pass_table_open(&table, pass_table,
+				     HUBBLE_PASS_TABLE_HEADER_SIZE - 1);
+	zassert_equal(ret, -EBADMSG);
+
+	memcpy(buffer, pass_table, sizeof(pass_table));
+	buffer[0] ^= 1U;
+	ret = hubble_pass_table_open(&table, buffer, sizeof(pass_table));
+	zassert_equal(ret, -EBADMSG);
+
+	memcpy(buffer, pass_table, sizeof(pass_table));
+	buffer[4]++;
+	ret = hubble_pass_table_open(&table, buffer, sizeof(pass_table));
+	zassert_equal(ret, -ENOTSUP);
+
+	/* Corrupted duration */
+	memcpy(buffer, pass_table, sizeof(pass_table));
+	buffer[HUBBLE_PASS_TABLE_HEADER_SIZE + 4]++;
+	ret = hubble_pass_table_open(&table, buffer, sizeof(pass_table));
+	zassert_equal(ret, -EBADMSG);
+
+	/* Empty pass, with a valid CRC */
+	memcpy(buffer, pass_table, sizeof(pass_table));
+	buffer[HUBBLE_PASS_TABLE_HEADER_SIZE + 4] = 0U;
+	buffer[HUBBLE_PASS_TABLE_HEADER_SIZE + 5] = 0U;
+	crc = hubble_crc32(&buffer[HUBBLE_PASS_TABLE_HEADER_SIZE],
+			   sizeof(pass_table) - HUBBLE_PASS_TABLE_HEADER_SIZE);
+	sys_put_le32(crc, &buffer[8]);
+	ret = hubble_pass_table_open(&table, buffer, sizeof(pass_table));
+	zassert_equal(ret, -EBADMSG);
+
+	/* A larger buffer is fine */
+	memcpy(buffer, pass_table, sizeof(pass_table));
+	ret = hubble_pass_table_open(&table, buffer, sizeof(buffer));
+	zassert_ok(ret);
+	zassert_equal(hubble_pass_table_count(&table), ARRAY_SIZE(passes));
+}
+
+ZTEST_SUITE(pass_table_test, NULL, NULL, NULL, NULL, NULL);
@@ -8,12 +8,15 @@
 #include <hubble/sat.h>
 #include <hubble/sat/packet.h>
 
+#include "hubble_priv.h"
+
 #include <zephyr/sys/util.h>
 #include <zephyr/types.h>
 #include <zephyr/ztest.h>
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define HUBBLE_SAT_DEV_ID 0x1337
 
@@ -48,16 +51,104 @@ int hubble_sat_board_disable(void)
 }
 
 static uint8_t _transmission_count;
+static const struct hubble_sat_packet *_first_packet;
 
 int hubble_sat_board_packet_send(const struct hubble_sat_packet *packet)
 {
-	ARG_UNUSED(packet);
+	if (_first_packet == NULL) {
+		_first_packet = packet;
+	}
 
 	_transmission_count--;
 
 	return 0;
 }
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+/* Storage of the sequence numbers, replaces the settings one. */
+static uint32_t _sequence_stored;
+static uint32_t _sequence_store_count;
+static int _sequence_store_ret;
+
+int hubble_sat_port_sequence_load(uint32_t *lease_end)
+{
+	*lease_end = _sequence_stored;
+
+	return 0;
+}
+
+int hubble_sat_port_sequence_store(uint32_t lease_end)
+{
+	_sequence_store_count++;
+	if (_sequence_store_ret != 0) {
+		return _sequence_store_ret;
+	}
+
+	_sequence_stored = lease_end;
+
+	return 0;
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST */
+
+#ifndef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED
+/* Symbols of the PHY header and bits of a symbol */
+#define FRAME_OFFSET      6U
+#define FRAME_SYMBOL_SIZE 6U
+
+/* Bit offsets of the frame fields */
+#define FRAME_SEQUENCE_OFFSET 2U
+#define FRAME_DEVICE_OFFSET   12U
+#define FRAME_TAG_OFFSET      44U
+#define FRAME_PAYLOAD_OFFSET  76U
+
+/* Frame of a packet, with the whitening removed */
+static size_t _frame_get(const struct hubble_sat_packet *packet,
+			 uint8_t *symbols)
+{
+	size_t length = packet->length - FRAME_OFFSET;
+	uint8_t state = (3U << 5) | 0x40U | packet->channel;
+
+	memcpy(symbols, &packet->data[FRAME_OFFSET], length);
+
+	for (size_t i = 0; i < (length * FRAME_SYMBOL_SIZE); i++) {
+		symbols[i / FRAME_SYMBOL_SIZE] ^=
+			((state >> 6) & 1U)
+			<< (FRAME_SYMBOL_SIZE - 1U - (i % FRAME_SYMBOL_SIZE));
+		state = ((state << 1) & 0x7FU) |
+			(((state >> 6) ^ (state >> 3)) & 1U);
+	}
+
+	return length;
+}
+
+/* Fields are sent most significant bit first */
+static uint64_t _frame_bits_get(const uint8_t *symbols, size_t offset,
+				size_t size)
+{
+	uint64_t value = 0;
+
+	for (size_t i = offset; i < (offset + size); i++) {
+		value = (value << 1) |
+			((symbols[i / FRAME_SYMBOL_SIZE] >>
+			  (FRAME_SYMBOL_SIZE - 1U - (i % FRAME_SYMBOL_SIZE))) &
+			 1U);
+	}
+
+	return value;
+}
+
+/* The payload is sent as a little endian number, so its last byte goes
+ * first.
+ */
+static uint8_t _frame_payload_byte_get(const uint8_t *symbols, size_t length,
+				       size_t index)
+{
+	return (uint8_t)_frame_bits_get(
+		symbols, FRAME_PAYLOAD_OFFSET + ((length - 1U - index) * 8U),
+		8U);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED */
+
 ZTEST(sat_test, test_packet)
 {
 	int err;
@@ -93,6 +184,465 @@ ZTEST(sat_test, test_packet)
 	zassert_not_ok(err);
 }
 
+ZTEST(sat_test, test_auth_tag)
+{
+	int err;
+	uint16_t sequence;
+	uint8_t tag[4];
+	uint8_t payload[] = {0xde, 0xad, 0xbe, 0xef};
+	/* AES-CMAC of the sequence number 0x2a5, the device id and the
+	 * payload, with the key derived from sat_key for the day of _utc.
+	 */
+	static const uint8_t expected[] = {0x10, 0x58, 0x2c, 0xd0};
+#ifndef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED
+	uint8_t symbols[HUBBLE_PACKET_MAX_SIZE];
+	struct hubble_sat_packet pkt;
+#endif
+
+	err = hubble_internal_sat_auth_tag_get(0x2a5, HUBBLE_SAT_DEV_ID,
+					       payload, sizeof(payload), tag,
+					       sizeof(tag));
+	zassert_ok(err);
+	zassert_mem_equal(expected, tag, sizeof(tag));
+
+	/* Shorter tags are truncated */
+	err = hubble_internal_sat_auth_tag_get(0x2a5, HUBBLE_SAT_DEV_ID,
+					       payload, sizeof(payload), tag,
+					       2U);
+	zassert_ok(err);
+	zassert_mem_equal(expected, tag, 2U);
+
+	err = hubble_internal_sat_auth_tag_get(0x2a5, HUBBLE_SAT_DEV_ID,
+					       NULL, sizeof(payload), tag,
+					       sizeof(tag));
+	zassert_equal(-EINVAL, err);
+
+	/* A key changed in place is used once it is set again */
+	sat_key[0] ^= 0xFF;
+	err = hubble_key_set(sat_key);
+	zassert_ok(err);
+	err = hubble_internal_sat_auth_tag_get(0x2a5, HUBBLE_SAT_DEV_ID,
+					       payload, sizeof(payload), tag,
+					       sizeof(tag));
+	zassert_ok(err);
+	zassert_true(memcmp(expected, tag, sizeof(tag)) != 0);
+
+	sat_key[0] ^= 0xFF;
+	err = hubble_key_set(sat_key);
+	zassert_ok(err);
+	err = hubble_internal_sat_auth_tag_get(0x2a5, HUBBLE_SAT_DEV_ID,
+					       payload, sizeof(payload), tag,
+					       sizeof(tag));
+	zassert_ok(err);
+	zassert_mem_equal(expected, tag, sizeof(tag));
+
+#ifndef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED
+	/* Next packet gets the same sequence number */
+	err = hubble_internal_sat_sequence_get(1U, &sequence);
+	zassert_ok(err);
+	err = hubble_internal_sat_sequence_get(
+		(uint16_t)((0x2a5 - sequence - 1U) & 0x3FFU), &sequence);
+	zassert_ok(err);
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, payload,
+				    sizeof(payload));
+	zassert_ok(err);
+
+	_frame_get(&pkt, symbols);
+	zassert_equal(0x2a5, _frame_bits_get(symbols, FRAME_SEQUENCE_OFFSET,
+					    10U));
+	zassert_equal(HUBBLE_SAT_DEV_ID,
+		      _frame_bits_get(symbols, FRAME_DEVICE_OFFSET, 32U));
+	/* The tag is sent like the payload, last byte first */
+	zassert_equal(0xd02c5810U,
+		      _frame_bits_get(symbols, FRAME_TAG_OFFSET, 32U));
+#else
+	ARG_UNUSED(sequence);
+#endif
+}
+
+#ifndef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_DEPRECATED
+ZTEST(sat_test, test_packet_template)
+{
+	int err;
+	uint8_t buffer[HUBBLE_SAT_PAYLOAD_MAX] = {0};
+	size_t sizes[] = {0, 4, 9, HUBBLE_SAT_PAYLOAD_MAX};
+	uint8_t frame[HUBBLE_PACKET_MAX_SIZE];
+	uint8_t frame_tmpl[HUBBLE_PACKET_MAX_SIZE];
+	size_t length;
+	uint16_t sequence;
+	struct hubble_sat_packet_template tmpl;
+	struct hubble_sat_packet pkt, pkt_tmpl;
+
+	/* Sanity check. Invalid sizes and parameters */
+	err = hubble_sat_packet_template_init(&tmpl, HUBBLE_SAT_DEV_ID, 1);
+	zassert_not_ok(err);
+
+	err = hubble_sat_packet_template_init(NULL, HUBBLE_SAT_DEV_ID, 0);
+	zassert_not_ok(err);
+
+	err = hubble_sat_packet_template_init(&tmpl, HUBBLE_SAT_DEV_ID, 4);
+	zassert_ok(err);
+
+	err = hubble_sat_packet_from_template_get(&pkt_tmpl, &tmpl, NULL);
+	zassert_not_ok(err);
+
+	err = hubble_sat_packet_from_template_get(NULL, &tmpl, buffer);
+	zassert_not_ok(err);
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(buffer); i++) {
+		buffer[i] = 0x11 * (i + 1);
+	}
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		err = hubble_sat_packet_template_init(&tmpl, HUBBLE_SAT_DEV_ID,
+						      sizes[i]);
+		zassert_ok(err);
+
+		err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, buffer,
+					    sizes[i]);
+		zassert_ok(err);
+		length = _frame_get(&pkt, frame);
+
+		zassert_equal(HUBBLE_SAT_DEV_ID,
+			      _frame_bits_get(frame, FRAME_DEVICE_OFFSET, 32U));
+		for (size_t k = 0; k < sizes[i]; k++) {
+			zassert_equal(buffer[k], _frame_payload_byte_get(
+							 frame, sizes[i], k));
+		}
+
+		/* The template can be used multiple times */
+		for (uint8_t j = 0; j < 2; j++) {
+			/* Sequence numbers are 10 bits, skip to the one of
+			 * pkt so both frames are the same.
+			 */
+			err = hubble_internal_sat_sequence_get(1023U,
+							       &sequence);
+			zassert_ok(err);
+
+			err = hubble_sat_packet_from_template_get(&pkt_tmpl,
+								  &tmpl, buffer);
+			zassert_ok(err);
+			zassert_equal(pkt.length, pkt_tmpl.length);
+			zassert_equal(length,
+				      _frame_get(&pkt_tmpl, frame_tmpl));
+			zassert_mem_equal(frame, frame_tmpl, length);
+		}
+	}
+}
+
+ZTEST(sat_test, test_packet_channel_variant)
+{
+	int err;
+	uint8_t buffer[HUBBLE_SAT_PAYLOAD_MAX] = {0};
+	struct hubble_sat_packet pkt, variant, original;
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, buffer, 9);
+	zassert_ok(err);
+
+	err = hubble_sat_packet_channel_variant_get(&pkt,
+						    HUBBLE_SAT_NUM_CHANNELS,
+						    &variant);
+	zassert_not_ok(err);
+
+	err = hubble_sat_packet_channel_variant_get(NULL, 0, &variant);
+	zassert_not_ok(err);
+
+	for (uint8_t channel = 0; channel < HUBBLE_SAT_NUM_CHANNELS;
+	     channel++) {
+		err = hubble_sat_packet_channel_variant_get(&pkt, channel,
+							    &variant);
+		zassert_ok(err);
+		zassert_equal(channel, variant.channel);
+		zassert_equal(pkt.hopping_sequence, variant.hopping_sequence);
+		zassert_equal(pkt.length, variant.length);
+
+		/* Going back to the original channel gives the same packet */
+		err = hubble_sat_packet_channel_variant_get(
+			&variant, pkt.channel, &original);
+		zassert_ok(err);
+		zassert_mem_equal(pkt.data, original.data, pkt.length);
+	}
+}
+
+ZTEST(sat_test, test_packet_fragments)
+{
+	int err;
+	size_t count;
+	uint8_t message[HUBBLE_SAT_MESSAGE_MAX + 1] = {0};
+	uint16_t sequence, first = 0;
+	uint8_t frame[HUBBLE_PACKET_MAX_SIZE];
+	struct hubble_sat_packet pkts[HUBBLE_SAT_FRAGMENTS_MAX];
+	struct hubble_sat_packet pkt;
+	/* Fragment payloads of a 40 bytes message (1, 2, ..., 40). They
+	 * are also the input of the tests of tools/sat_reassemble.py.
+	 */
+	static const uint8_t fragments[][HUBBLE_SAT_PAYLOAD_MAX] = {
+		{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+		 0x0a, 0x0b, 0x0c},
+		{0x10, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15,
+		 0x16, 0x17, 0x18},
+		{0x20, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21,
+		 0x22, 0x23, 0x24},
+		/* Last fragment: 4 bytes and 4 padding bytes */
+		{0x3c, 0x25, 0x26, 0x27, 0x28, 0x00, 0x00, 0x00, 0x00},
+	};
+
+	zassert_equal(1, hubble_sat_packet_fragments_count(0));
+	zassert_equal(1, hubble_sat_packet_fragments_count(
+				 HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX));
+	zassert_equal(2, hubble_sat_packet_fragments_count(
+				 HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX + 1));
+	zassert_equal(HUBBLE_SAT_FRAGMENTS_MAX,
+		      hubble_sat_packet_fragments_count(HUBBLE_SAT_MESSAGE_MAX));
+	zassert_not_ok(hubble_sat_packet_fragments_count(
+		HUBBLE_SAT_MESSAGE_MAX + 1));
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_packet_fragments_get(pkts, &count, HUBBLE_SAT_DEV_ID,
+					      message,
+					      HUBBLE_SAT_MESSAGE_MAX + 1);
+	zassert_not_ok(err);
+
+	count = 3;
+	err = hubble_sat_packet_fragments_get(pkts, &count, HUBBLE_SAT_DEV_ID,
+					      message, 40);
+	zassert_equal(-ENOMEM, err);
+
+	/* 40 bytes: three full packets and a smaller one (9 bytes) */
+	for (uint8_t i = 0; i < 40; i++) {
+		message[i] = i + 1;
+	}
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_packet_fragments_get(pkts, &count, HUBBLE_SAT_DEV_ID,
+					      message, 40);
+	zassert_ok(err);
+	zassert_equal(ARRAY_SIZE(fragments), count);
+
+	for (uint8_t i = 0; i < count; i++) {
+		size_t size = (i < 3) ? HUBBLE_SAT_PAYLOAD_MAX : 9;
+
+		err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, message,
+					    size);
+		zassert_ok(err);
+		zassert_equal(pkt.length, pkts[i].length);
+
+		_frame_get(&pkts[i], frame);
+		zassert_equal(HUBBLE_SAT_DEV_ID,
+			      _frame_bits_get(frame, FRAME_DEVICE_OFFSET, 32U));
+
+		/* Fragments of a message have consecutive sequence numbers,
+		 * the receiver identifies the message with the first one.
+		 */
+		sequence = _frame_bits_get(frame, FRAME_SEQUENCE_OFFSET, 10U);
+		if (i == 0U) {
+			first = sequence;
+		}
+		zassert_equal((first + i) & 0x3FFU, sequence);
+
+		/* Header (index, last flag and padding) and message slice */
+		for (uint8_t k = 0; k < size; k++) {
+			zassert_equal(fragments[i][k],
+				      _frame_payload_byte_get(frame, size, k),
+				      "fragment %u byte %u", i, k);
+		}
+	}
+
+	/* Empty message still needs the header */
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_packet_fragments_get(pkts, &count, HUBBLE_SAT_DEV_ID,
+					      NULL, 0);
+	zassert_ok(err);
+	zassert_equal(1, count);
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, message, 4);
+	zassert_ok(err);
+	zassert_equal(pkt.length, pkts[0].length);
+}
+
+/* Checks the size and the payload of a flushed packet */
+static void _aggregator_payload_check(const struct hubble_sat_packet *packet,
+				      const uint8_t *payload, size_t length)
+{
+	int err;
+	uint8_t frame[HUBBLE_PACKET_MAX_SIZE];
+	struct hubble_sat_packet pkt;
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, payload, length);
+	zassert_ok(err);
+	zassert_equal(pkt.length, packet->length);
+
+	_frame_get(packet, frame);
+	zassert_equal(HUBBLE_SAT_DEV_ID,
+		      _frame_bits_get(frame, FRAME_DEVICE_OFFSET, 32U));
+	for (uint8_t i = 0; i < length; i++) {
+		zassert_equal(payload[i],
+			      _frame_payload_byte_get(frame, length, i),
+			      "byte %u", i);
+	}
+}
+
+ZTEST(sat_test, test_aggregator)
+{
+	int err;
+	size_t count;
+	uint8_t buffer[32];
+	uint8_t value[HUBBLE_SAT_RECORD_VALUE_MAX] = {0};
+	struct hubble_sat_aggregator agg;
+	struct hubble_sat_packet pkts[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+	static const uint8_t values[][7] = {
+		{0xa1, 0xa2},
+		{0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7},
+		{0xc1, 0xc2, 0xc3},
+		{0xd1},
+	};
+	/* Largest records first: tag 2 (8 bytes) and tag 3 (4 bytes) fill
+	 * a full packet, tag 1 (3 bytes) and tag 4 (2 bytes) go in a 9
+	 * bytes one. A zero header ends the records of a payload.
+	 */
+	static const uint8_t payload0[] = {0x27, 0xb1, 0xb2, 0xb3, 0xb4,
+					   0xb5, 0xb6, 0xb7, 0x33, 0xc1,
+					   0xc2, 0xc3, 0x00};
+	static const uint8_t payload1[] = {0x12, 0xa1, 0xa2, 0x41, 0xd1,
+					   0x00, 0x00, 0x00, 0x00};
+
+	err = hubble_sat_aggregator_init(&agg, HUBBLE_SAT_DEV_ID, NULL,
+					 sizeof(buffer), 0, 0);
+	zassert_not_ok(err);
+
+	err = hubble_sat_aggregator_init(&agg, HUBBLE_SAT_DEV_ID, buffer,
+					 sizeof(buffer), 16, UINT32_MAX);
+	zassert_ok(err);
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+
+	/* Sanity check. Invalid tags and lengths */
+	zassert_not_ok(hubble_sat_aggregator_add(&agg, 0, value, 1));
+	zassert_not_ok(hubble_sat_aggregator_add(
+		&agg, HUBBLE_SAT_RECORD_TAG_MAX + 1, value, 1));
+	zassert_not_ok(hubble_sat_aggregator_add(
+		&agg, 1, value, HUBBLE_SAT_RECORD_VALUE_MAX + 1));
+
+	/* 3 + 8 + 4 + 2 bytes */
+	zassert_ok(hubble_sat_aggregator_add(&agg, 1, values[0], 2));
+	zassert_ok(hubble_sat_aggregator_add(&agg, 2, values[1], 7));
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+	zassert_ok(hubble_sat_aggregator_add(&agg, 3, values[2], 3));
+	zassert_ok(hubble_sat_aggregator_add(&agg, 4, values[3], 1));
+	zassert_true(hubble_sat_aggregator_ready(&agg));
+	zassert_equal(2, hubble_sat_aggregator_packets_count(&agg));
+
+	count = 1;
+	err = hubble_sat_aggregator_flush(&agg, pkts, &count);
+	zassert_equal(-ENOMEM, err);
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_aggregator_flush(&agg, pkts, &count);
+	zassert_ok(err);
+	zassert_equal(2, count);
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+
+	_aggregator_payload_check(&pkts[0], payload0, sizeof(payload0));
+	_aggregator_payload_check(&pkts[1], payload1, sizeof(payload1));
+}
+
+ZTEST(sat_test, test_aggregator_overflow)
+{
+	int err;
+	size_t count;
+	uint8_t buffer[32];
+	uint8_t large_buffer[(HUBBLE_SAT_AGGREGATOR_PACKETS_MAX + 1) *
+			     HUBBLE_SAT_PAYLOAD_MAX];
+	uint8_t value[HUBBLE_SAT_RECORD_VALUE_MAX];
+	uint8_t payload[HUBBLE_SAT_PAYLOAD_MAX];
+	struct hubble_sat_aggregator agg;
+	struct hubble_sat_packet pkts[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+
+	/* Only flushed when the buffer is full */
+	err = hubble_sat_aggregator_init(&agg, HUBBLE_SAT_DEV_ID, buffer,
+					 sizeof(buffer), 0, UINT32_MAX);
+	zassert_ok(err);
+
+	for (uint8_t i = 0; i < sizeof(value); i++) {
+		value[i] = i + 1;
+	}
+
+	zassert_ok(hubble_sat_aggregator_add(&agg, 1, value, 12));
+	zassert_ok(hubble_sat_aggregator_add(&agg, 2, value, 12));
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+	zassert_equal(-ENOMEM, hubble_sat_aggregator_add(&agg, 3, value, 12));
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_aggregator_flush(&agg, pkts, &count);
+	zassert_ok(err);
+	zassert_equal(2, count);
+
+	/* A record of 12 bytes fills a packet */
+	payload[0] = 0x1c;
+	memcpy(&payload[1], value, sizeof(value));
+	_aggregator_payload_check(&pkts[0], payload, sizeof(payload));
+	payload[0] = 0x2c;
+	_aggregator_payload_check(&pkts[1], payload, sizeof(payload));
+
+	/* The rejected record fits after the flush */
+	zassert_ok(hubble_sat_aggregator_add(&agg, 3, value, 12));
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_aggregator_flush(&agg, pkts, &count);
+	zassert_ok(err);
+	zassert_equal(1, count);
+	payload[0] = 0x3c;
+	_aggregator_payload_check(&pkts[0], payload, sizeof(payload));
+
+	/* Records that need more packets than a flush produces */
+	err = hubble_sat_aggregator_init(&agg, HUBBLE_SAT_DEV_ID, large_buffer,
+					 sizeof(large_buffer), 0, UINT32_MAX);
+	zassert_ok(err);
+
+	for (size_t i = 0; i < HUBBLE_SAT_AGGREGATOR_PACKETS_MAX; i++) {
+		zassert_ok(hubble_sat_aggregator_add(&agg, 1, value, 12));
+	}
+	zassert_equal(-ENOMEM, hubble_sat_aggregator_add(&agg, 1, value, 12));
+	zassert_equal(HUBBLE_SAT_AGGREGATOR_PACKETS_MAX,
+		      hubble_sat_aggregator_packets_count(&agg));
+}
+
+ZTEST(sat_test, test_aggregator_timeout)
+{
+	int err;
+	size_t count;
+	uint8_t buffer[32];
+	struct hubble_sat_aggregator agg;
+	struct hubble_sat_packet pkts[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+	static const uint8_t value[] = {0xa1, 0xa2};
+	static const uint8_t payload[] = {0x12, 0xa1, 0xa2, 0x20};
+
+	/* The threshold is never reached. Both records fit in 4 bytes. */
+	err = hubble_sat_aggregator_init(&agg, HUBBLE_SAT_DEV_ID, buffer,
+					 sizeof(buffer), sizeof(buffer), 1000U);
+	zassert_ok(err);
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+
+	zassert_ok(hubble_sat_aggregator_add(&agg, 1, value, sizeof(value)));
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+
+	/* The delay starts with the oldest record */
+	k_sleep(K_MSEC(500));
+	zassert_ok(hubble_sat_aggregator_add(&agg, 2, NULL, 0));
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+
+	k_sleep(K_MSEC(500));
+	zassert_true(hubble_sat_aggregator_ready(&agg));
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_aggregator_flush(&agg, pkts, &count);
+	zassert_ok(err);
+	zassert_equal(1, count);
+	zassert_false(hubble_sat_aggregator_ready(&agg));
+
+	_aggregator_payload_check(&pkts[0], payload, sizeof(payload));
+}
+#endif
+
 ZTEST(sat_test, test_profile)
 {
 	int err;
@@ -113,6 +663,11 @@ ZTEST(sat_test, test_profile)
 	/* Checking no transmissions happened. */
 	zassert_equal(16U, _transmission_count);
 
+	/* Sanity check. No transmissions */
+	err = hubble_sat_port_packet_send(&pkt, 0U, 1U);
+	zassert_equal(-EINVAL, err);
+	zassert_equal(16U, _transmission_count);
+
 	/* Test no reliability. One time transmission */
 	_transmission_count = 1U;
 	err = hubble_sat_packet_send(&pkt, HUBBLE_SAT_RELIABILITY_NONE);
@@ -132,6 +687,257 @@ ZTEST(sat_test, test_profile)
 	zassert_equal(0, _transmission_count);
 }
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+static K_SEM_DEFINE(_async_sem, 0, CONFIG_HUBBLE_SAT_NETWORK_TX_QUEUE_SIZE);
+static int _async_status;
+
+static void _async_cb(const struct hubble_sat_packet *packet, int status,
+		      void *user_data)
+{
+	ARG_UNUSED(packet);
+	ARG_UNUSED(user_data);
+
+	_async_status = status;
+	k_sem_give(&_async_sem);
+}
+
+ZTEST(sat_test, test_send_async)
+{
+	int err;
+	struct hubble_sat_packet pkt;
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, NULL, 0);
+	zassert_ok(err);
+
+	/* Sanity check. Invalid packet and reliability */
+	err = hubble_sat_packet_send_async(NULL, HUBBLE_SAT_RELIABILITY_NONE,
+					   _async_cb, NULL);
+	zassert_not_ok(err);
+
+	err = hubble_sat_packet_send_async(&pkt, 255, _async_cb, NULL);
+	zassert_not_ok(err);
+
+	/* One time transmission */
+	_transmission_count = 1U;
+	err = hubble_sat_packet_send_async(&pkt, HUBBLE_SAT_RELIABILITY_NONE,
+					   _async_cb, NULL);
+	zassert_ok(err);
+	zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+	zassert_ok(_async_status);
+	zassert_equal(0, _transmission_count);
+
+	/* Cancel it while waiting for re-transmissions */
+	_transmission_count = 8U;
+	err = hubble_sat_packet_send_async(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL,
+					   _async_cb, NULL);
+	zassert_ok(err);
+
+	/* The same packet can not be queued twice */
+	err = hubble_sat_packet_send_async(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL,
+					   _async_cb, NULL);
+	zassert_equal(-EBUSY, err);
+
+	k_sleep(K_SECONDS(1));
+	zassert_equal(7U, _transmission_count);
+
+	err = hubble_sat_packet_send_cancel(&pkt);
+	zassert_ok(err);
+	zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+	zassert_equal(-ECANCELED, _async_status);
+	zassert_equal(7U, _transmission_count);
+
+	/* Nothing else to cancel */
+	err = hubble_sat_packet_send_cancel(&pkt);
+	zassert_not_ok(err);
+}
+
+ZTEST(sat_test, test_send_queue)
+{
+	int err;
+	struct hubble_sat_packet pkts[CONFIG_HUBBLE_SAT_NETWORK_TX_QUEUE_SIZE];
+	struct hubble_sat_packet pkt;
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(pkts); i++) {
+		err = hubble_sat_packet_get(&pkts[i], HUBBLE_SAT_DEV_ID, NULL,
+					    0);
+		zassert_ok(err);
+	}
+
+	/* The packet with lower priority value goes first */
+	_first_packet = NULL;
+	_transmission_count = 2U;
+	k_sched_lock();
+	err = hubble_sat_packet_enqueue(&pkts[0], HUBBLE_SAT_RELIABILITY_NONE,
+					1U, _async_cb, NULL);
+	zassert_ok(err);
+	err = hubble_sat_packet_enqueue(&pkts[1], HUBBLE_SAT_RELIABILITY_NONE,
+					0U, _async_cb, NULL);
+	zassert_ok(err);
+	k_sched_unlock();
+
+	for (uint8_t i = 0; i < 2; i++) {
+		zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+		zassert_ok(_async_status);
+	}
+	zassert_equal(0, _transmission_count);
+	zassert_equal_ptr(&pkts[1], _first_packet);
+
+	/* Fill the queue, nothing else fits */
+	_transmission_count = UINT8_MAX;
+	for (uint8_t i = 0; i < ARRAY_SIZE(pkts); i++) {
+		err = hubble_sat_packet_enqueue(&pkts[i],
+						HUBBLE_SAT_RELIABILITY_HIGH, i,
+						_async_cb, NULL);
+		zassert_ok(err);
+	}
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, NULL, 0);
+	zassert_ok(err);
+	err = hubble_sat_packet_send_async(&pkt, HUBBLE_SAT_RELIABILITY_NONE,
+					   _async_cb, NULL);
+	zassert_equal(-ENOMEM, err);
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(pkts); i++) {
+		err = hubble_sat_packet_send_cancel(&pkts[i]);
+		zassert_ok(err);
+	}
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(pkts); i++) {
+		zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+		zassert_equal(-ECANCELED, _async_status);
+	}
+}
+
+ZTEST(sat_test, test_send_blocking_queue)
+{
+	int err;
+	int64_t start_ms;
+	struct hubble_sat_packet pkt, blocking_pkt;
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, NULL, 0);
+	zassert_ok(err);
+	err = hubble_sat_packet_get(&blocking_pkt, HUBBLE_SAT_DEV_ID, NULL, 0);
+	zassert_ok(err);
+
+	/* The queue waits for the next re-transmission */
+	_transmission_count = 8U;
+	err = hubble_sat_packet_send_async(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL,
+					   _async_cb, NULL);
+	zassert_ok(err);
+	k_sleep(K_SECONDS(1));
+	zassert_equal(7U, _transmission_count);
+
+	/* A blocking transmission does not wait for the queue to drain */
+	start_ms = k_uptime_get();
+	err = hubble_sat_packet_send(&blocking_pkt,
+				     HUBBLE_SAT_RELIABILITY_NONE);
+	zassert_ok(err);
+	zassert_true(k_uptime_delta(&start_ms) < 5000);
+	zassert_equal(6U, _transmission_count);
+
+	err = hubble_sat_packet_send_cancel(&pkt);
+	zassert_ok(err);
+	zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+	zassert_equal(-ECANCELED, _async_status);
+}
+
+/* Next pass is a few hours after _utc */
+static const struct orbit_info orbit = {
+	.t0 = 1711296587,
+	.n0 = 0.00017559780215620866,
+	.ndot = 3.6984685877857914e-14,
+	.raan0 = -2.62346138227064,
+	.raandot = 1.992330418167161e-07,
+	.aop0 = 3.523598389978097,
+	.aopdot = -6.981828658074634e-07,
+	.inclination = 97.4608,
+	.eccentricity = 0.0010652};
+static const struct ground_info ground = {47.0, -122.0};
+
+ZTEST(sat_test, test_send_pass)
+{
+	int err;
+	struct hubble_sat_packet pkt;
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, NULL, 0);
+	zassert_ok(err);
+
+	err = hubble_sat_packet_pass_enqueue(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL,
+					     HUBBLE_SAT_TX_PRIORITY_DEFAULT,
+					     NULL, &ground, _async_cb, NULL);
+	zassert_equal(-EINVAL, err);
+
+	err = hubble_sat_packet_pass_enqueue(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL,
+					     HUBBLE_SAT_TX_PRIORITY_DEFAULT,
+					     &orbit, NULL, _async_cb, NULL);
+	zassert_equal(-EINVAL, err);
+
+	/* The transmission is deferred to the pass */
+	_transmission_count = 8U;
+	err = hubble_sat_packet_pass_enqueue(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL,
+					     HUBBLE_SAT_TX_PRIORITY_DEFAULT,
+					     &orbit, &ground, _async_cb, NULL);
+	zassert_ok(err);
+
+	k_sleep(K_SECONDS(2));
+	zassert_equal(8U, _transmission_count);
+
+	err = hubble_sat_packet_send_cancel(&pkt);
+	zassert_ok(err);
+	zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+	zassert_equal(-ECANCELED, _async_status);
+	zassert_equal(8U, _transmission_count);
+
+	/* Retries picked from the pass geometry */
+	err = hubble_sat_packet_pass_enqueue(
+		&pkt, HUBBLE_SAT_RELIABILITY_ADAPTIVE,
+		HUBBLE_SAT_TX_PRIORITY_DEFAULT, &orbit, &ground, _async_cb, NULL);
+	zassert_ok(err);
+
+	err = hubble_sat_packet_send_cancel(&pkt);
+	zassert_ok(err);
+	zassert_ok(k_sem_take(&_async_sem, K_SECONDS(5)));
+	zassert_equal(-ECANCELED, _async_status);
+	zassert_equal(8U, _transmission_count);
+}
+ZTEST(sat_test, test_adaptive_retries)
+{
+	uint8_t zenith, edge;
+	/* Pass right above the ground and its transmissions window around
+	 * the pass centre.
+	 */
+	struct hubble_pass_info pass = {
+		.lon = -122.0,
+		.t = 1711315802,
+		.duration = 600,
+	};
+	uint64_t start_s = pass.t + 240;
+	uint64_t window_s = 120;
+
+	zenith = hubble_internal_sat_adaptive_retries_get(
+		&orbit, &ground, &pass, start_s, window_s);
+	zassert_true(zenith >= 1U);
+
+	/* Transmissions far from the centre have a higher path loss */
+	zassert_true(hubble_internal_sat_adaptive_retries_get(
+			     &orbit, &ground, &pass, pass.t, pass.duration) >
+		     zenith);
+
+	/* Same window of a pass 10 degrees of longitude away */
+	pass.lon += 10.0;
+	edge = hubble_internal_sat_adaptive_retries_get(&orbit, &ground, &pass,
+							start_s, window_s);
+	zassert_true(edge > zenith, "zenith %u edge %u", zenith, edge);
+	zassert_true(edge < 16U);
+
+	/* Below the horizon, the retries of the high reliability are used */
+	pass.lon += 20.0;
+	zassert_equal(16U, hubble_internal_sat_adaptive_retries_get(
+				   &orbit, &ground, &pass, start_s,
+				   window_s));
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 ZTEST(sat_test, test_channel_hopping)
 {
 	int ret;
@@ -164,10 +970,338 @@ ZTEST(sat_test, test_channel_hopping)
 	}
 }
 
+ZTEST(sat_test, test_packet_schedule)
+{
+	int err;
+	size_t count, symbol = 0;
+	uint8_t preamble_on = 0, channel;
+	uint8_t buffer[HUBBLE_SAT_PAYLOAD_MAX] = {0};
+	const int8_t *preamble = HUBBLE_SAT_PREAMBLE_SEQUENCE;
+	struct hubble_sat_packet pkt;
+	struct hubble_sat_schedule_entry schedule[HUBBLE_SAT_SCHEDULE_ENTRIES_MAX];
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, buffer,
+				    HUBBLE_SAT_PAYLOAD_MAX);
+	zassert_ok(err);
+
+	count = 1;
+	err = hubble_sat_packet_schedule_get(&pkt, schedule, &count);
+	zassert_equal(-ENOMEM, err);
+
+	err = hubble_sat_packet_schedule_get(NULL, schedule, &count);
+	zassert_equal(-EINVAL, err);
+
+	count = ARRAY_SIZE(schedule);
+	err = hubble_sat_packet_schedule_get(&pkt, schedule, &count);
+	zassert_ok(err);
+
+	for (uint8_t i = 0; i < HUBBLE_SAT_PREAMBLE_LENGTH; i++) {
+		if (preamble[i] >= 0) {
+			preamble_on++;
+		}
+	}
+
+	channel = pkt.channel;
+	for (size_t i = 0; i < count; i++) {
+		zassert_true(schedule[i].duration_us > 0);
+
+		/* Off periods are merged */
+		if (!schedule[i].on) {
+			zassert_true((i + 1 == count) || schedule[i + 1].on);
+			continue;
+		}
+
+		zassert_equal(HUBBLE_WAIT_SYMBOL_US, schedule[i].duration_us);
+
+		if (preamble_on > 0) {
+			zassert_equal(pkt.channel, schedule[i].channel);
+			preamble_on--;
+			continue;
+		}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_PROTOCOL_V1
+		if ((symbol > 0) && ((symbol % HUBBLE_SAT_SYMBOLS_FRAME_MAX) == 0)) {
+			err = hubble_sat_channel_next_hop_get(
+				pkt.hopping_sequence, channel, &channel);
+			zassert_ok(err);
+		}
+#endif
+		zassert_equal(channel, schedule[i].channel);
+		zassert_equal(pkt.data[symbol], schedule[i].step);
+		symbol++;
+	}
+
+	zassert_equal(pkt.length, symbol);
+}
+
+ZTEST(sat_test, test_packet_pack)
+{
+	int err;
+	uint8_t symbol;
+	uint8_t buffer[HUBBLE_SAT_PAYLOAD_MAX] = {0xde, 0xad, 0xbe, 0xef};
+	struct hubble_sat_packet pkt, unpacked;
+	struct hubble_sat_packet_packed packed;
+
+	zassert_true(sizeof(packed) < sizeof(pkt));
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, buffer,
+				    HUBBLE_SAT_PAYLOAD_MAX);
+	zassert_ok(err);
+
+	zassert_equal(-EINVAL, hubble_sat_packet_pack(NULL, &pkt));
+	zassert_equal(-EINVAL, hubble_sat_packet_unpack(&unpacked, NULL));
+
+	err = hubble_sat_packet_pack(&packed, &pkt);
+	zassert_ok(err);
+	zassert_equal(pkt.length, packed.length);
+
+	for (size_t i = 0; i < pkt.length; i++) {
+		err = hubble_sat_packet_packed_symbol_get(&packed, i, &symbol);
+		zassert_ok(err);
+		zassert_equal(pkt.data[i], symbol);
+	}
+
+	/* Sanity check. Invalid parameters and out of bounds symbol */
+	zassert_equal(-EINVAL,
+		      hubble_sat_packet_packed_symbol_get(NULL, 0, &symbol));
+	zassert_equal(-EINVAL,
+		      hubble_sat_packet_packed_symbol_get(&packed, 0, NULL));
+	zassert_equal(-EINVAL, hubble_sat_packet_packed_symbol_get(
+				       &packed, packed.length, &symbol));
+
+	err = hubble_sat_packet_unpack(&unpacked, &packed);
+	zassert_ok(err);
+	zassert_equal(pkt.length, unpacked.length);
+	zassert_equal(pkt.channel, unpacked.channel);
+	zassert_equal(pkt.hopping_sequence, unpacked.hopping_sequence);
+	zassert_mem_equal(pkt.data, unpacked.data, pkt.length);
+}
+
+ZTEST(sat_test, test_sequence)
+{
+	uint16_t first, sequence;
+
+	zassert_equal(-EINVAL, hubble_internal_sat_sequence_get(1U, NULL));
+
+	/* Blocks are contiguous */
+	zassert_ok(hubble_internal_sat_sequence_get(1U, &first));
+	zassert_ok(hubble_internal_sat_sequence_get(5U, &sequence));
+	zassert_equal((uint16_t)(first + 1U), sequence);
+	zassert_ok(hubble_internal_sat_sequence_get(1U, &sequence));
+	zassert_equal((uint16_t)(first + 6U), sequence);
+
+	/* Numbers wrap around, also in the middle of a block */
+	zassert_ok(hubble_internal_sat_sequence_get(
+		(uint16_t)(UINT16_MAX - sequence - 1U), &sequence));
+	zassert_ok(hubble_internal_sat_sequence_get(3U, &sequence));
+	zassert_equal(UINT16_MAX, sequence);
+	zassert_ok(hubble_internal_sat_sequence_get(1U, &sequence));
+	zassert_equal(2U, sequence);
+}
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST
+ZTEST(sat_test, test_sequence_lease)
+{
+	uint16_t sequence;
+	uint32_t start = 0x100000U;
+
+	/* Resumes from the end of the stored lease */
+	_sequence_stored = start;
+	zassert_ok(hubble_internal_sat_sequence_load());
+
+	_sequence_store_count = 0U;
+	zassert_ok(hubble_internal_sat_sequence_get(1U, &sequence));
+	zassert_equal((uint16_t)start, sequence);
+	zassert_equal(1U, _sequence_store_count);
+	zassert_equal(start + 1U + CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE,
+		      _sequence_stored);
+
+	/* Storage is only written when the lease is used */
+	for (int i = 0; i < CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE;
+	     i++) {
+		zassert_ok(hubble_internal_sat_sequence_get(1U, &sequence));
+	}
+	zassert_equal(1U, _sequence_store_count);
+
+	zassert_ok(hubble_internal_sat_sequence_get(2U, &sequence));
+	zassert_equal(2U, _sequence_store_count);
+	zassert_equal(start + 3U +
+			      (2U * CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE),
+		      _sequence_stored);
+
+	/* A failed store gives the numbers back */
+	_sequence_store_ret = -EIO;
+	zassert_equal(-EIO,
+		      hubble_internal_sat_sequence_get(
+			      CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE + 1U,
+			      &sequence));
+	zassert_equal(3U, _sequence_store_count);
+
+	_sequence_store_ret = 0;
+	zassert_ok(hubble_internal_sat_sequence_get(1U, &sequence));
+	zassert_equal(3U, _sequence_store_count);
+	zassert_equal((uint16_t)(start + 3U +
+				 CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE),
+		      sequence);
+
+	/* And the store is tried again past the stored lease */
+	zassert_ok(hubble_internal_sat_sequence_get(
+		CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE + 1U, &sequence));
+	zassert_equal(4U, _sequence_store_count);
+	zassert_equal((uint16_t)(start + 4U +
+				 CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE),
+		      sequence);
+	zassert_equal(start + 5U +
+			      (3U * CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_LEASE_SIZE),
+		      _sequence_stored);
+
+	/* A lease older than the current numbers is ignored */
+	_sequence_stored = start;
+	zassert_ok(hubble_internal_sat_sequence_load());
+	zassert_ok(hubble_internal_sat_sequence_get(1U, &sequence));
+	zassert_not_equal((uint16_t)start, sequence);
+}
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_SEQUENCE_PERSIST */
+
+/* Drift estimated over a span of syncs: the skew plus the sync error */
+#define DRIFT_PPM(_skew, _span_ms)                                             \
+	MIN((_skew) + ((2ULL * CONFIG_HUBBLE_SAT_NETWORK_SYNC_ACCURACY_MS *    \
+			1000000ULL) /                                          \
+		       (_span_ms)),                                            \
+	    CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR)
+
+ZTEST(sat_test, test_clock_drift)
+{
+	uint64_t base = 1760210751803ULL;
+	/* 20 ppm over 10000 s */
+	uint64_t uptime2[] = {1000U, 10001000U};
+	uint64_t base2[] = {base, base + 200U};
+	/* 30 ppm over 20000 s, in the order of the ring buffer */
+	uint64_t uptime3[] = {10005000U, 20005000U, 5000U};
+	uint64_t base3[] = {base - 300U, base - 600U, base};
+	/* 1000 ppm */
+	uint64_t base_fast[] = {base, base + 10000U};
+	uint64_t uptime_same[] = {1000U, 1000U};
+
+	/* Not enough syncs */
+	zassert_equal(CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR,
+		      hubble_internal_clock_drift_ppm_estimate(uptime2, base2,
+							       0U));
+	zassert_equal(CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR,
+		      hubble_internal_clock_drift_ppm_estimate(uptime2, base2,
+							       1U));
+	zassert_equal(CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR,
+		      hubble_internal_clock_drift_ppm_estimate(NULL, base2,
+							       2U));
+
+	/* Syncs at the same uptime */
+	zassert_equal(CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR,
+		      hubble_internal_clock_drift_ppm_estimate(uptime_same,
+							       base2, 2U));
+
+	zassert_within(
+		hubble_internal_clock_drift_ppm_estimate(uptime2, base2, 2U),
+		DRIFT_PPM(20U, 10000000U), 1U);
+	zassert_within(
+		hubble_internal_clock_drift_ppm_estimate(uptime3, base3, 3U),
+		DRIFT_PPM(30U, 20000000U), 1U);
+
+	/* Bounded by the configured drift */
+	zassert_equal(CONFIG_HUBBLE_SAT_NETWORK_DEVICE_TDR,
+		      hubble_internal_clock_drift_ppm_estimate(uptime2,
+							       base_fast, 2U));
+}
+
+ZTEST(sat_test, test_airtime)
+{
+	int err;
+	uint64_t airtime_us = 0;
+	struct hubble_sat_packet pkt;
+	struct hubble_sat_schedule_entry schedule[HUBBLE_SAT_SCHEDULE_ENTRIES_MAX];
+	size_t count = ARRAY_SIZE(schedule);
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	struct hubble_sat_stats stats;
+#endif
+
+	err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, NULL, 0);
+	zassert_ok(err);
+
+	err = hubble_sat_packet_schedule_get(&pkt, schedule, &count);
+	zassert_ok(err);
+
+	for (size_t i = 0; i < count; i++) {
+		airtime_us += schedule[i].duration_us;
+	}
+
+	zassert_equal(airtime_us, hubble_sat_airtime_estimate(
+					  &pkt, HUBBLE_SAT_RELIABILITY_NONE));
+	zassert_equal(8U * airtime_us,
+		      hubble_sat_airtime_estimate(
+			      &pkt, HUBBLE_SAT_RELIABILITY_NORMAL));
+	/* Without a pass the adaptive mode behaves like the normal one */
+	zassert_equal(8U * airtime_us,
+		      hubble_sat_airtime_estimate(
+			      &pkt, HUBBLE_SAT_RELIABILITY_ADAPTIVE));
+	zassert_equal(0, hubble_sat_airtime_estimate(NULL,
+						    HUBBLE_SAT_RELIABILITY_NONE));
+	zassert_equal(0, hubble_sat_airtime_estimate(&pkt, 255));
+
+	/* Clock drift only adds re-transmissions */
+	zassert_equal(airtime_us, hubble_sat_airtime_drift_estimate(
+					  &pkt, HUBBLE_SAT_RELIABILITY_NONE));
+	zassert_true(hubble_sat_airtime_drift_estimate(
+			     &pkt, HUBBLE_SAT_RELIABILITY_NORMAL) >=
+		     8U * airtime_us);
+	zassert_equal(0, hubble_sat_airtime_drift_estimate(
+				 NULL, HUBBLE_SAT_RELIABILITY_NONE));
+	zassert_equal(0, hubble_sat_airtime_drift_estimate(&pkt, 255));
+
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_STATS
+	zassert_equal(-EINVAL, hubble_sat_stats_get(NULL));
+
+	hubble_sat_stats_reset();
+	_transmission_count = 8U;
+	err = hubble_sat_packet_send(&pkt, HUBBLE_SAT_RELIABILITY_NORMAL);
+	zassert_ok(err);
+
+	err = hubble_sat_stats_get(&stats);
+	zassert_ok(err);
+	zassert_equal(1U, stats.packets);
+	zassert_equal(7U, stats.retries);
+	zassert_equal(8U * airtime_us, stats.airtime_us);
+	zassert_true(stats.symbols > (8U * pkt.length));
+
+	hubble_sat_stats_reset();
+	err = hubble_sat_stats_get(&stats);
+	zassert_ok(err);
+	zassert_equal(0, stats.packets);
+	zassert_equal(0, stats.airtime_us);
+#endif
+}
+
 static void *sat_test_setup(void)
 {
 	int err;
 
+#ifdef CONFIG_HUBBLE_SAT_NETWORK_ASYNC
+	static struct hubble_sat_packet pkt;
+
+	/* Nothing can be queued before the SDK is initialized */
+	err = hubble_sat_packet_send_async(&pkt, HUBBLE_SAT_RELIABILITY_NONE,
+					   _async_cb, NULL);
+	zassert_equal(-EAGAIN, err);
+
+	err = hubble_sat_packet_enqueue(&pkt, HUBBLE_SAT_RELIABILITY_NONE,
+					HUBBLE_SAT_TX_PRIORITY_DEFAULT,
+					_async_cb, NULL);
+	zassert_equal(-EAGAIN, err);
+
+	err = hubble_sat_packet_pass_enqueue(
+		&pkt, HUBBLE_SAT_RELIABILITY_NONE,
+		HUBBLE_SAT_TX_PRIORITY_DEFAULT, &orbit, &ground, _async_cb, NULL);
+	zassert_equal(-EAGAIN, err);
+#endif /* CONFIG_HUBBLE_SAT_NETWORK_ASYNC */
+
 	err = hubble_init(_utc, sat_key);
 	zassert_ok(err);
 
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <hubble/hubble.h>
+#include <hubble/sat/packet.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/types.h>
+#include <zephyr/ztest.h>
+
+#include <stdint.h>
+
+#define HUBBLE_SAT_DEV_ID 0x1337
+
+static uint64_t _utc = 1760210751803ULL;
+/* zRWlq8BgtnKIph5E6ZW6d9FAvUZWS4jeQcFaknOwzoU= */
+static uint8_t sat_key[CONFIG_HUBBLE_KEY_SIZE] = {
+	0xcd, 0x15, 0xa5, 0xab, 0xc0, 0x60, 0xb6, 0x72, 0x88, 0xa6, 0x1e,
+	0x44, 0xe9, 0x95, 0xba, 0x77, 0xd1, 0x40, 0xbd, 0x46, 0x56, 0x4b,
+	0x88, 0xde, 0x41, 0xc1, 0x5a, 0x92, 0x73, 0xb0, 0xce, 0x85};
+
+/* Implement sat board support. */
+int hubble_sat_board_init(void)
+{
+	return 0;
+}
+
+int hubble_sat_board_enable(void)
+{
+	return 0;
+}
+
+int hubble_sat_board_disable(void)
+{
+	return 0;
+}
+
+int hubble_sat_board_packet_send(const struct hubble_sat_packet *packet)
+{
+	ARG_UNUSED(packet);
+
+	return 0;
+}
+
+static bool _size_enabled(size_t size)
+{
+	switch (size) {
+	case 0:
+		return IS_ENABLED(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_0);
+	case 4:
+		return IS_ENABLED(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_4);
+	case 9:
+		return IS_ENABLED(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_9);
+	case 13:
+		return IS_ENABLED(CONFIG_HUBBLE_SAT_NETWORK_PAYLOAD_SIZE_13);
+	default:
+		return false;
+	}
+}
+
+ZTEST(sat_payload_sizes_test, test_packet_sizes)
+{
+	int err;
+	struct hubble_sat_packet pkt;
+	static const size_t sizes[] = {0, 4, 9, 13};
+	uint8_t payload[HUBBLE_SAT_PAYLOAD_MAX] = {0};
+
+	for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		err = hubble_sat_packet_get(&pkt, HUBBLE_SAT_DEV_ID, payload,
+					    sizes[i]);
+		if (_size_enabled(sizes[i])) {
+			zassert_ok(err, "size %zu", sizes[i]);
+		} else {
+			zassert_equal(-EINVAL, err, "size %zu", sizes[i]);
+		}
+	}
+}
+
+ZTEST(sat_payload_sizes_test, test_fragments)
+{
+	int err;
+	size_t count;
+	struct hubble_sat_packet pkts[HUBBLE_SAT_FRAGMENTS_MAX];
+	uint8_t message[HUBBLE_SAT_MESSAGE_MAX] = {0};
+
+	/* Fits in a single packet */
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_packet_fragments_get(pkts, &count, HUBBLE_SAT_DEV_ID,
+					      message, 7);
+	zassert_ok(err);
+	zassert_equal(1, count);
+
+	if (!_size_enabled(HUBBLE_SAT_PAYLOAD_MAX)) {
+		/* Messages that need a full packet can not be sent */
+		count = ARRAY_SIZE(pkts);
+		err = hubble_sat_packet_fragments_get(
+			pkts, &count, HUBBLE_SAT_DEV_ID, message, 11);
+		zassert_equal(-ENOTSUP, err);
+
+		count = ARRAY_SIZE(pkts);
+		err = hubble_sat_packet_fragments_get(
+			pkts, &count, HUBBLE_SAT_DEV_ID, message,
+			HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX + 1);
+		zassert_equal(-ENOTSUP, err);
+		return;
+	}
+
+	/* The padding of the last fragment only goes up to 7 bytes */
+	if (!_size_enabled(9)) {
+		count = ARRAY_SIZE(pkts);
+		err = hubble_sat_packet_fragments_get(
+			pkts, &count, HUBBLE_SAT_DEV_ID, message, 4);
+		zassert_equal(-ENOTSUP, err);
+
+		count = ARRAY_SIZE(pkts);
+		err = hubble_sat_packet_fragments_get(
+			pkts, &count, HUBBLE_SAT_DEV_ID, message,
+			HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX + 1);
+		zassert_equal(-ENOTSUP, err);
+	}
+
+	if (!_size_enabled(4)) {
+		count = ARRAY_SIZE(pkts);
+		err = hubble_sat_packet_fragments_get(
+			pkts, &count, HUBBLE_SAT_DEV_ID, message, 0);
+		zassert_equal(-ENOTSUP, err);
+	}
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_packet_fragments_get(
+		pkts, &count, HUBBLE_SAT_DEV_ID, message,
+		2 * HUBBLE_SAT_FRAGMENT_PAYLOAD_MAX);
+	zassert_ok(err);
+	zassert_equal(2, count);
+}
+
+ZTEST(sat_payload_sizes_test, test_aggregator)
+{
+	int err;
+	size_t count;
+	size_t largest = 0;
+	size_t value_max;
+	struct hubble_sat_aggregator agg;
+	struct hubble_sat_packet pkts[HUBBLE_SAT_AGGREGATOR_PACKETS_MAX];
+	uint8_t buffer[64];
+	uint8_t value[HUBBLE_SAT_RECORD_VALUE_MAX] = {0};
+
+	for (size_t size = 0; size <= HUBBLE_SAT_PAYLOAD_MAX; size++) {
+		if (_size_enabled(size)) {
+			largest = size;
+		}
+	}
+
+	value_max = largest - HUBBLE_SAT_RECORD_HEADER_SIZE;
+
+	err = hubble_sat_aggregator_init(&agg, HUBBLE_SAT_DEV_ID, buffer,
+					 sizeof(buffer), 0, 0);
+	zassert_ok(err);
+
+	/* Records must fit in the largest enabled payload size */
+	if (largest < HUBBLE_SAT_PAYLOAD_MAX) {
+		err = hubble_sat_aggregator_add(&agg, 1, value, value_max + 1);
+		zassert_equal(-EINVAL, err);
+	}
+
+	err = hubble_sat_aggregator_add(&agg, 1, value, value_max);
+	zassert_ok(err);
+	err = hubble_sat_aggregator_add(&agg, 2, value, 1);
+	zassert_ok(err);
+	zassert_equal(2, hubble_sat_aggregator_packets_count(&agg));
+
+	count = ARRAY_SIZE(pkts);
+	err = hubble_sat_aggregator_flush(&agg, pkts, &count);
+	zassert_ok(err);
+	zassert_equal(2, count);
+}
+
+static void *sat_payload_sizes_test_setup(void)
+{
+	int err;
+
+	err = hubble_init(_utc, sat_key);
+	zassert_ok(err);
+
+	return NULL;
+}
+
+ZTEST_SUITE(sat_payload_sizes_test, NULL, sat_payload_sizes_test_setup, NULL,
+	    NULL, NULL);
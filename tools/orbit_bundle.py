@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2026 Hubble Network, Inc.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Generate an orbit bundle read with hubble_orbit_bundle_open().
+
+The input is a JSON list of records, one per set of orbital elements:
+
+  [
+    {
+      "id": 1,
+      "valid_start": 1711296587,
+      "valid_end": 1711901387,
+      "t0": 1711296587,
+      "n0": 0.00017559780215620866,
+      "ndot": 3.6984685877857914e-14,
+      "raan0": -2.62346138227064,
+      "raandot": 1.992330418167161e-07,
+      "aop0": 3.523598389978097,
+      "aopdot": -6.981828658074634e-07,
+      "inclination": 97.4608,
+      "eccentricity": 0.0010652
+    }
+  ]
+
+valid_start and valid_end default to t0 and to no end. The layout is
+described in include/hubble/sat/orbit_bundle.h.
+"""
+
+import json
+import struct
+import sys
+import zlib
+from typing import BinaryIO, List, TextIO
+
+import click
+
+BUNDLE_MAGIC = b"HORB"
+BUNDLE_VERSION = 1
+
+# magic, version, reserved, count, record_size, crc
+HEADER = struct.Struct("<4sBBHII")
+# t0, n0, ndot, raan0, raandot, aop0, aopdot, inclination, eccentricity,
+# valid_start, valid_end, id, reserved
+RECORD = struct.Struct("<Q8dQQII")
+
+ORBIT_FIELDS = (
+    "n0",
+    "ndot",
+    "raan0",
+    "raandot",
+    "aop0",
+    "aopdot",
+    "inclination",
+    "eccentricity",
+)
+
+UINT64_MAX = (1 << 64) - 1
+COUNT_MAX = (1 << 16) - 1
+
+
+def pack_record(record: dict) -> bytes:
+    """Returns the binary record of a set of orbital elements."""
+    t0 = int(record["t0"])
+    valid_start = int(record.get("valid_start", t0))
+    valid_end = int(record.get("valid_end", UINT64_MAX))
+
+    if record["n0"] <= 0:
+        raise ValueError("n0 must be positive")
+    if not 0 <= record["eccentricity"] < 1:
+        raise ValueError("eccentricity must be in [0, 1)")
+    if not 0 <= record["inclination"] <= 180:
+        raise ValueError("inclination must be in [0, 180]")
+    if valid_start > valid_end:
+        raise ValueError("valid_start is after valid_end")
+
+    return RECORD.pack(
+        t0,
+        *(float(record[field]) for field in ORBIT_FIELDS),
+        valid_start,
+        valid_end,
+        int(record["id"]),
+        0,
+    )
+
+
+def pack(records: List[dict]) -> bytes:
+    """Returns the orbit bundle of a list of records."""
+    if len(records) > COUNT_MAX:
+        raise ValueError(f"Too many records, the maximum is {COUNT_MAX}")
+
+    data = b"".join(pack_record(record) for record in records)
+    header = HEADER.pack(
+        BUNDLE_MAGIC,
+        BUNDLE_VERSION,
+        0,
+        len(records),
+        RECORD.size,
+        zlib.crc32(data),
+    )
+
+    return header + data
+
+
+def c_array(name: str, bundle: bytes) -> str:
+    """Returns the bundle as an aligned C array."""
+    lines = [
+        "/*",
+        " * This file contents was automatically generated.",
+        " */",
+        f"static const uint8_t {name}[] __attribute__((aligned(8))) = {{",
+    ]
+    for offset in range(0, len(bundle), 12):
+        chunk = bundle[offset : offset + 12]
+        lines.append("\t" + " ".join(f"0x{byte:02x}," for byte in chunk))
+    lines.append("};")
+
+    return "\n".join(lines) + "\n"
+
+
+@click.command(context_settings={"help_option_names": ["-h", "--help"]})
+@click.argument("input_file", type=click.File("r"), default="-")
+@click.argument("output_file", type=click.File("wb"), default="-")
+@click.option(
+    "-c",
+    "--c-array",
+    "name",
+    metavar="NAME",
+    help="Write a C array with the given name instead of binary data.",
+)
+def main(input_file: TextIO, output_file: BinaryIO, name: str) -> None:
+    """Generate an orbit bundle from the JSON records in INPUT_FILE."""
+    try:
+        records = json.load(input_file)
+        bundle = pack(records)
+    except (KeyError, TypeError, ValueError) as err:
+        raise click.ClickException(f"Invalid records: {err}")
+
+    if name is not None:
+        output_file.write(c_array(name, bundle).encode())
+    else:
+        output_file.write(bundle)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2026 Hubble Network, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host generator of the pass tables read with hubble_pass_table_open().
+ *
+ * It runs the ephemeris of the SDK over the orbits of an orbit bundle
+ * (tools/orbit_bundle.py) and writes the passes of all the satellites
+ * over a location or a region, from a start time and for a horizon.
+ *
+ * Usage: pass_table (-p lat,lon | -r lat_mid,lat_range,lon_mid,lon_range)
+ *                   [-s start] [-d horizon_s] [-c name] bundle [output]
+ *
+ * Passes over a location span the visibility window of the pass
+ * (hubble_next_pass_window_get()), the ones with an empty window are
+ * left out. Passes over a region span the time the ground track is in
+ * the region (hubble_next_pass_region_get()). Overlapping passes of
+ * different satellites are merged. The start time defaults to now and
+ * the horizon to 7 days. With -c, a C array with the given name is
+ * written instead of binary data.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hubble/sat/ephemeris.h>
+#include <hubble/sat/orbit_bundle.h>
+#include <hubble/sat/pass_table.h>
+
+#include "utils/crc32.h"
+
+#define PASS_TABLE_HORIZON_S    (7U * 24U * 3600U)
+#define PASS_TABLE_COUNT_MAX    UINT16_MAX
+#define PASS_TABLE_DURATION_MAX UINT16_MAX
+#define PASS_TABLE_OFFSET_MAX   UINT32_MAX
+
+struct table_pass {
+	uint64_t start;
+	uint64_t end;
+};
+
+struct table_query {
+	bool region;
+	struct ground_info ground;
+	struct ground_region_info area;
+	uint64_t start;
+	uint64_t end;
+};
+
+static struct table_pass *_passes;
+static size_t _count;
+static size_t _size;
+
+static void _usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s (-p lat,lon | -r lat_mid,lat_range,lon_mid,"
+		"lon_range)\n"
+		"          [-s start] [-d horizon_s] [-c name] bundle [output]\n",
+		name);
+}
+
+static int _pass_add(uint64_t start, uint64_t end,
+		     const struct table_query *query)
+{
+	struct table_pass *passes;
+
+	/* Passes in progress at the start time are cut. Empty passes are
+	 * dropped, lookups never match them and tables can not hold them.
+	 */
+	start = (start < query->start) ? query->start : start;
+	if (end <= start) {
+		return 0;
+	}
+
+	if (_count == _size) {
+		_size = (_size == 0) ? 64 : _size * 2;
+		passes = realloc(_passes, _size * sizeof(_passes[0]));
+		if (passes == NULL) {
+			return -1;
+		}
+		_passes = passes;
+	}
+
+	_passes[_count].start = start;
+	_passes[_count].end = end;
+	_count++;
+
+	return 0;
+}
+
+static int _pass_cmp(const void *a, const void *b)
+{
+	const struct table_pass *x = a;
+	const struct table_pass *y = b;
+
+	return (x->start > y->start) - (x->start < y->start);
+}
+
+/* Sorts the passes and merges the ones that overlap */
+static void _passes_merge(void)
+{
+	size_t n = 0;
+
+	if (_count == 0) {
+		return;
+	}
+
+	qsort(_passes, _count, sizeof(_passes[0]), _pass_cmp);
+
+	for (size_t i = 1; i < _count; i++) {
+		if (_passes[i].start <= _passes[n].end) {
+			if (_passes[i].end > _passes[n].end) {
+				_passes[n].end = _passes[i].end;
+			}
+		} else {
+			_passes[++n] = _passes[i];
+		}
+	}
+
+	_count = n + 1;
+}
+
+/* First time after t from which a record of the satellite is valid */
+static bool _next_valid_get(const struct hubble_orbit_bundle *bundle,
+			    uint32_t id, uint64_t t, uint64_t *next)
+{
+	const struct hubble_orbit_record *record;
+	bool found = false;
+
+	for (size_t i = 0; i < hubble_orbit_bundle_count(bundle); i++) {
+		record = hubble_orbit_bundle_record_get(bundle, i);
+		if ((record->id != id) || (record->valid_start <= t)) {
+			continue;
+		}
+
+		if (!found || (record->valid_start < *next)) {
+			*next = record->valid_start;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+/* Adds the passes of a satellite, switching to newer elements as they
+ * become valid.
+ */
+static int _satellite_passes_add(const struct hubble_orbit_bundle *bundle,
+				 uint32_t id, const struct table_query *query)
+{
+	const struct orbit_info *orbit;
+	const struct hubble_orbit_record *record;
+	struct hubble_pass_window_info window;
+	struct hubble_pass_info pass;
+	uint64_t t = query->start, centre;
+
+	while (t < query->end) {
+		orbit = hubble_orbit_bundle_find(bundle, id, t);
+		if (orbit == NULL) {
+			if (!_next_valid_get(bundle, id, t, &t)) {
+				break;
+			}
+			continue;
+		}
+		/* The elements are the first field of their record */
+		record = (const struct hubble_orbit_record *)orbit;
+
+		if (query->region) {
+			if (hubble_next_pass_region_get(orbit, t, &query->area,
+							&pass) != 0) {
+				break;
+			}
+			centre = pass.t + (pass.duration / 2);
+		} else {
+			if (hubble_next_pass_window_get(orbit, t, &query->ground,
+							&window) != 0) {
+				break;
+			}
+			pass = window.pass;
+			pass.t = window.start;
+			pass.duration = (uint32_t)(window.end - window.start);
+			centre = window.pass.t;
+		}
+
+		if (centre > record->valid_end) {
+			/* Search again with the elements valid then */
+			t = record->valid_end + 1;
+			continue;
+		}
+
+		if (pass.t >= query->end) {
+			break;
+		}
+
+		if (_pass_add(pass.t, pass.t + pass.duration, query) != 0) {
+			return -1;
+		}
+
+		t = centre + 1;
+	}
+
+	return 0;
+}
+
+static void _le_put(uint8_t *data, uint64_t value, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		data[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+/* Returns the table, or NULL if the passes do not fit in the format */
+static uint8_t *_table_pack(uint64_t base, size_t *len)
+{
+	uint8_t *table, *entry;
+
+	if (_count > PASS_TABLE_COUNT_MAX) {
+		fprintf(stderr, "Too many passes, the maximum is %u\n",
+			PASS_TABLE_COUNT_MAX);
+		return NULL;
+	}
+
+	*len = HUBBLE_PASS_TABLE_HEADER_SIZE +
+	       (_count * HUBBLE_PASS_TABLE_ENTRY_SIZE);
+	table = calloc(1, *len);
+	if (table == NULL) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < _count; i++) {
+		if (((_passes[i].start - base) > PASS_TABLE_OFFSET_MAX) ||
+		    (_passes[i].end <= _passes[i].start) ||
+		    ((_passes[i].end - _passes[i].start) >
+		     PASS_TABLE_DURATION_MAX)) {
+			fprintf(stderr, "Pass at %" PRIu64 " does not fit\n",
+				_passes[i].start);
+			free(table);
+			return NULL;
+		}
+
+		entry = table + HUBBLE_PASS_TABLE_HEADER_SIZE +
+			(i * HUBBLE_PASS_TABLE_ENTRY_SIZE);
+		_le_put(entry, _passes[i].start - base, 4);
+		_le_put(entry + 4, _passes[i].end - _passes[i].start, 2);
+	}
+
+	_le_put(table, HUBBLE_PASS_TABLE_MAGIC, 4);
+	table[4] = HUBBLE_PASS_TABLE_VERSION;
+	_le_put(table + 6, _count, 2);
+	_le_put(table + 8,
+		hubble_crc32(table + HUBBLE_PASS_TABLE_HEADER_SIZE,
+			     *len - HUBBLE_PASS_TABLE_HEADER_SIZE),
+		4);
+	_le_put(table + 12, base, 8);
+
+	return table;
+}
+
+static void _c_array_write(FILE *output, const char *name,
+			   const uint8_t *table, size_t len)
+{
+	fprintf(output, "/*\n");
+	fprintf(output, " * This file contents was automatically generated.\n");
+	fprintf(output, " */\n");
+	fprintf(output, "static const uint8_t %s[] = {\n", name);
+	for (size_t i = 0; i < len; i += 12) {
+		fprintf(output, "\t");
+		for (size_t j = i; (j < len) && (j < (i + 12)); j++) {
+			fprintf(output, "0x%02x,%s", table[j],
+				((j + 1 < len) && (j + 1 < i + 12)) ? " " : "");
+		}
+		fprintf(output, "\n");
+	}
+	fprintf(output, "};\n");
+}
+
+static uint8_t *_file_read(const char *path, size_t *len)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *data = NULL;
+	long size;
+
+	if (file == NULL) {
+		perror(path);
+		return NULL;
+	}
+
+	if ((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0) ||
+	    (fseek(file, 0, SEEK_SET) != 0)) {
+		perror(path);
+		goto out;
+	}
+
+	/* malloc alignment is enough for the records */
+	data = malloc((size == 0) ? 1 : (size_t)size);
+	if ((data != NULL) &&
+	    (fread(data, 1, (size_t)size, file) != (size_t)size)) {
+		perror(path);
+		free(data);
+		data = NULL;
+	}
+	*len = (size_t)size;
+
+out:
+	fclose(file);
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	struct table_query query = {0};
+	struct hubble_orbit_bundle bundle;
+	const struct hubble_orbit_record *record;
+	uint64_t horizon = PASS_TABLE_HORIZON_S;
+	const char *name = NULL;
+	bool location = false;
+	uint8_t *data, *table;
+	size_t len, table_len;
+	FILE *output = stdout;
+	int opt, ret;
+
+	query.start = (uint64_t)time(NULL);
+
+	while ((opt = getopt(argc, argv, "p:r:s:d:c:")) != -1) {
+		switch (opt) {
+		case 'p':
+			if (sscanf(optarg, "%lf,%lf", &query.ground.lat,
+				   &query.ground.lon) != 2) {
+				_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			location = true;
+			query.region = false;
+			break;
+		case 'r':
+			if (sscanf(optarg, "%lf,%lf,%lf,%lf",
+				   &query.area.lat_mid, &query.area.lat_range,
+				   &query.area.lon_mid,
+				   &query.area.lon_range) != 4) {
+				_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			location = true;
+			query.region = true;
+			break;
+		case 's':
+			query.start = strtoull(optarg, NULL, 10);
+			break;
+		case 'd':
+			horizon = strtoull(optarg, NULL, 10);
+			break;
+		case 'c':
+			name = optarg;
+			break;
+		default:
+			_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!location || (optind >= argc) || ((argc - optind) > 2)) {
+		_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	query.end = query.start + horizon;
+
+	data = _file_read(argv[optind], &len);
+	if (data == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	ret = hubble_orbit_bundle_open(&bundle, data, len);
+	if (ret != 0) {
+		fprintf(stderr, "%s: invalid orbit bundle (%d)\n",
+			argv[optind], ret);
+		free(data);
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < hubble_orbit_bundle_count(&bundle); i++) {
+		bool done = false;
+
+		record = hubble_orbit_bundle_record_get(&bundle, i);
+		/* Every satellite once, from its first record */
+		for (size_t j = 0; j < i; j++) {
+			if (hubble_orbit_bundle_record_get(&bundle, j)->id ==
+			    record->id) {
+				done = true;
+				break;
+			}
+		}
+
+		if (!done && (_satellite_passes_add(&bundle, record->id,
+						    &query) != 0)) {
+			free(data);
+			return EXIT_FAILURE;
+		}
+	}
+
+	_passes_merge();
+
+	table = _table_pack(query.start, &table_len);
+	free(_passes);
+	free(data);
+	if (table == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	if ((optind + 1) < argc) {
+		output = fopen(argv[optind + 1], (name != NULL) ? "w" : "wb");
+		if (output == NULL) {
+			perror(argv[optind + 1]);
+			free(table);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (name != NULL) {
+		_c_array_write(output, name, table, table_len);
+	} else {
+		fwrite(table, 1, table_len, output);
+	}
+
+	if (output != stdout) {
+		fclose(output);
+	}
+	free(table);
+
+	fprintf(stderr, "%zu passes from %" PRIu64 " to %" PRIu64 "\n",
+		_count, query.start, query.end);
+
+	return EXIT_SUCCESS;
+}
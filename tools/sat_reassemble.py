@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2026 Hubble Network, Inc.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Reassemble messages split with hubble_sat_packet_fragments_get().
+
+Every fragment payload starts with a one byte header (MSB first):
+  - 4 bits: fragment index.
+  - 1 bit:  set in the last fragment.
+  - 3 bits: number of padding bytes at the end of the last fragment.
+
+Fragments of a message have consecutive sequence numbers, so the
+message is identified by the device and the sequence number of its
+first fragment.
+
+Input lines have the format "<device id> <sequence number> <payload hex>".
+"""
+
+import sys
+from typing import Dict, Optional, TextIO, Tuple
+
+import click
+
+SEQUENCE_NUMBER_MOD = 1 << 10
+FRAGMENT_HEADER_SIZE = 1
+FRAGMENT_INDEX_SHIFT = 4
+FRAGMENT_LAST = 1 << 3
+FRAGMENT_PADDING_MASK = 0x7
+
+
+class Reassembler:
+    def __init__(self) -> None:
+        # (device, first sequence number) -> {index: payload}
+        self._pending: Dict[Tuple[str, int], Dict[int, bytes]] = {}
+        # (device, first sequence number) -> number of fragments
+        self._count: Dict[Tuple[str, int], int] = {}
+
+    def add(self, device: str, seq: int, payload: bytes) -> Optional[bytes]:
+        """Add a fragment. Returns the message once all fragments arrived."""
+        if len(payload) < FRAGMENT_HEADER_SIZE:
+            raise ValueError("Fragment without header")
+
+        header = payload[0]
+        index = header >> FRAGMENT_INDEX_SHIFT
+        data = payload[FRAGMENT_HEADER_SIZE:]
+        key = (device, (seq - index) % SEQUENCE_NUMBER_MOD)
+
+        if header & FRAGMENT_LAST:
+            padding = header & FRAGMENT_PADDING_MASK
+            if padding > len(data):
+                raise ValueError("Invalid fragment padding")
+            data = data[: len(data) - padding]
+            self._count[key] = index + 1
+
+        fragments = self._pending.setdefault(key, {})
+        fragments[index] = data
+
+        count = self._count.get(key)
+        if count is None or len(fragments) < count:
+            return None
+
+        message = b"".join(fragments[i] for i in range(count))
+        del self._pending[key]
+        del self._count[key]
+
+        return message
+
+
+@click.command(context_settings={"help_option_names": ["-h", "--help"]})
+@click.argument("input_file", type=click.File("r"), default="-")
+def main(input_file: TextIO) -> None:
+    """Reassemble fragmented satellite messages read from INPUT_FILE."""
+    reassembler = Reassembler()
+
+    for line in input_file:
+        fields = line.split()
+        if not fields:
+            continue
+        if len(fields) != 3:
+            raise click.ClickException(f"Invalid line: {line.strip()}")
+
+        device, seq, payload = fields
+        message = reassembler.add(device, int(seq, 0), bytes.fromhex(payload))
+        if message is not None:
+            click.echo(f"{device} {message.hex()}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
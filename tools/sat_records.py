@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2026 Hubble Network, Inc.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Decode records aggregated with hubble_sat_aggregator_flush().
+
+Every record starts with a one byte header (MSB first):
+  - 4 bits: tag (1 to 15).
+  - 4 bits: length of the value in bytes.
+
+A zero header ends the records of a payload.
+
+Input lines have the format "<device id> <payload hex>".
+"""
+
+import sys
+from typing import List, TextIO, Tuple
+
+import click
+
+RECORD_HEADER_SIZE = 1
+RECORD_TAG_SHIFT = 4
+RECORD_LENGTH_MASK = 0x0F
+
+
+def decode(payload: bytes) -> List[Tuple[int, bytes]]:
+    """Returns the (tag, value) records of a payload."""
+    records = []
+    offset = 0
+
+    while offset < len(payload):
+        header = payload[offset]
+        if header == 0:
+            break
+
+        tag = header >> RECORD_TAG_SHIFT
+        length = header & RECORD_LENGTH_MASK
+        offset += RECORD_HEADER_SIZE
+        if offset + length > len(payload):
+            raise ValueError("Truncated record")
+
+        records.append((tag, payload[offset : offset + length]))
+        offset += length
+
+    return records
+
+
+@click.command(context_settings={"help_option_names": ["-h", "--help"]})
+@click.argument("input_file", type=click.File("r"), default="-")
+def main(input_file: TextIO) -> None:
+    """Decode aggregated satellite records read from INPUT_FILE."""
+    for line in input_file:
+        fields = line.split()
+        if not fields:
+            continue
+        if len(fields) != 2:
+            raise click.ClickException(f"Invalid line: {line.strip()}")
+
+        device, payload = fields
+        try:
+            records = decode(bytes.fromhex(payload))
+        except ValueError as err:
+            raise click.ClickException(f"{err}: {line.strip()}")
+
+        for tag, value in records:
+            click.echo(f"{device} {tag} {value.hex()}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())